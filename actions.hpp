@@ -1,9 +1,11 @@
 #include <iostream>
 #include <fstream>
 #include <list>
+#include <vector>
 #include <unordered_map>
 #include <unordered_set>
 #include "conditions.hpp"
+#include "state.hpp"
 
 using namespace std;
 
@@ -16,37 +18,37 @@ private:
     unordered_set<Condition, ConditionHasher, ConditionComparator> effects;
 
 public:
-    Action(string name, list<string> args,
-        unordered_set<Condition, ConditionHasher, ConditionComparator>& preconditions,
-        unordered_set<Condition, ConditionHasher, ConditionComparator>& effects)
+    Action(const string& name, const list<string>& args,
+        const unordered_set<Condition, ConditionHasher, ConditionComparator>& preconditions,
+        const unordered_set<Condition, ConditionHasher, ConditionComparator>& effects)
     {
         this->name = name;
-        for (string l : args)
+        for (const string& l : args)
         {
             this->args.push_back(l);
         }
-        for (Condition pc : preconditions)
+        for (const Condition& pc : preconditions)
         {
             this->preconditions.insert(pc);
         }
-        for (Condition pc : effects)
+        for (const Condition& pc : effects)
         {
             this->effects.insert(pc);
         }
     }
-    string get_name() const
+    const string& get_name() const
     {
         return this->name;
     }
-    list<string> get_args() const
+    const list<string>& get_args() const
     {
         return this->args;
     }
-    unordered_set<Condition, ConditionHasher, ConditionComparator> get_preconditions() const
+    const unordered_set<Condition, ConditionHasher, ConditionComparator>& get_preconditions() const
     {
         return this->preconditions;
     }
-    unordered_set<Condition, ConditionHasher, ConditionComparator> get_effects() const
+    const unordered_set<Condition, ConditionHasher, ConditionComparator>& get_effects() const
     {
         return this->effects;
     }
@@ -63,11 +65,11 @@ public:
     {
         os << ac.toString() << endl;
         os << "Precondition: ";
-        for (Condition precond : ac.get_preconditions())
+        for (const Condition& precond : ac.get_preconditions())
             os << precond;
         os << endl;
         os << "Effect: ";
-        for (Condition effect : ac.get_effects())
+        for (const Condition& effect : ac.get_effects())
             os << effect;
         os << endl;
         return os;
@@ -78,7 +80,7 @@ public:
         string temp = "";
         temp += this->get_name();
         temp += "(";
-        for (string l : this->get_args())
+        for (const string& l : this->get_args())
         {
             temp += l + ",";
         }
@@ -113,49 +115,195 @@ private:
     unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> grounded_preconditions;
     unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> grounded_effects;
 
+    // interned atom ids of the preconditions and effects
+    vector<int> precondition_atoms;
+    vector<int> negative_precondition_atoms;
+    vector<int> add_atoms;
+    vector<int> delete_atoms;
+
+    // the same atoms as bitsets over all atoms of the task
+    State precondition_mask;
+    State negative_precondition_mask;
+    State add_mask;
+    State delete_mask;
+
+    // XOR of the Zobrist keys of the effects that always flip an atom, and the
+    // effects whose flip depends on the state (not fixed by the preconditions)
+    uint64_t zobrist_delta = 0;
+    vector<int> conditional_add_atoms;
+    vector<int> conditional_delete_atoms;
+
 public:
-    GroundedAction(string name, list<string> arg_values)
+    GroundedAction(const string& name, const list<string>& arg_values)
     {
         this->name = name;
-        for (string ar : arg_values)
+        for (const string& ar : arg_values)
         {
             this->arg_values.push_back(ar);
         }
     }
 
-    GroundedAction(string name, list<string> arg_values,
-                   unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> precon,
-                   unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> effect)
+    GroundedAction(const string& name, const list<string>& arg_values,
+                   const unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator>& precon,
+                   const unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator>& effect)
     {
         this->name = name;
-        for (string ar : arg_values)
+        for (const string& ar : arg_values)
             this->arg_values.push_back(ar);
-        for (GroundedCondition gc : precon)
+        for (const GroundedCondition& gc : precon)
+        {
             this->grounded_preconditions.insert(gc);
-        for (GroundedCondition gc : effect)
+            if (gc.get_truth())
+                this->precondition_atoms.push_back(gc.get_atom_id());
+            else
+                this->negative_precondition_atoms.push_back(gc.get_atom_id());
+        }
+        for (const GroundedCondition& gc : effect)
+        {
             this->grounded_effects.insert(gc);
+            if (gc.get_truth())
+                this->add_atoms.push_back(gc.get_atom_id());
+            else
+                this->delete_atoms.push_back(gc.get_atom_id());
+        }
     }
 
-    string get_name() const
+    // Grounded action from interned atom ids, without the condition sets (used by the task cache)
+    GroundedAction(string name, list<string> arg_values, vector<int> precondition_atoms,
+                   vector<int> negative_precondition_atoms, vector<int> add_atoms, vector<int> delete_atoms)
+    {
+        this->name = move(name);
+        this->arg_values = move(arg_values);
+        this->precondition_atoms = move(precondition_atoms);
+        this->negative_precondition_atoms = move(negative_precondition_atoms);
+        this->add_atoms = move(add_atoms);
+        this->delete_atoms = move(delete_atoms);
+    }
+
+    const string& get_name() const
     {
         return this->name;
     }
 
-    list<string> get_arg_values() const
+    const list<string>& get_arg_values() const
     {
         return this->arg_values;
     }
 
-    unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> get_preconditions() const
+    const unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator>& get_preconditions() const
     {
         return this->grounded_preconditions;
     }
 
-    unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> get_effects() const
+    const unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator>& get_effects() const
     {
         return this->grounded_effects;
     }
 
+    const vector<int>& get_precondition_atoms() const
+    {
+        return this->precondition_atoms;
+    }
+
+    const vector<int>& get_negative_precondition_atoms() const
+    {
+        return this->negative_precondition_atoms;
+    }
+
+    const vector<int>& get_add_atoms() const
+    {
+        return this->add_atoms;
+    }
+
+    const vector<int>& get_delete_atoms() const
+    {
+        return this->delete_atoms;
+    }
+
+    // Build the bitset masks once the number of atoms of the task is known
+    void build_masks(int num_atoms)
+    {
+        this->precondition_mask = State(num_atoms, this->precondition_atoms);
+        this->negative_precondition_mask = State(num_atoms, this->negative_precondition_atoms);
+        this->add_mask = State(num_atoms, this->add_atoms);
+        this->delete_mask = State(num_atoms, this->delete_atoms);
+    }
+
+    // Precompute the Zobrist delta of the effects. Must be called after build_masks.
+    void build_zobrist_delta(const ZobristTable& zobrist)
+    {
+        this->zobrist_delta = 0;
+        this->conditional_add_atoms.clear();
+        this->conditional_delete_atoms.clear();
+        for (int atom_id : this->add_atoms)
+        {
+            if (this->precondition_mask.test(atom_id))
+                continue; // already true
+            if (this->negative_precondition_mask.test(atom_id))
+                this->zobrist_delta ^= zobrist.key(atom_id);
+            else
+                this->conditional_add_atoms.push_back(atom_id);
+        }
+        for (int atom_id : this->delete_atoms)
+        {
+            if (this->add_mask.test(atom_id) || this->negative_precondition_mask.test(atom_id))
+                continue; // add wins, or already false
+            if (this->precondition_mask.test(atom_id))
+                this->zobrist_delta ^= zobrist.key(atom_id);
+            else
+                this->conditional_delete_atoms.push_back(atom_id);
+        }
+    }
+
+    // Zobrist hash of the successor of state (with hash state_hash) under this action, in O(|effects|)
+    uint64_t successor_hash(uint64_t state_hash, const State& state, const ZobristTable& zobrist) const
+    {
+        uint64_t h = state_hash ^ this->zobrist_delta;
+        for (int atom_id : this->conditional_add_atoms)
+        {
+            if (!state.test(atom_id))
+                h ^= zobrist.key(atom_id);
+        }
+        for (int atom_id : this->conditional_delete_atoms)
+        {
+            if (state.test(atom_id))
+                h ^= zobrist.key(atom_id);
+        }
+        return h;
+    }
+
+    // Same as above for the relaxed successor, which ignores delete effects
+    uint64_t relaxed_successor_hash(uint64_t state_hash, const State& state, const ZobristTable& zobrist) const
+    {
+        uint64_t h = state_hash;
+        for (int atom_id : this->add_atoms)
+        {
+            if (!state.test(atom_id))
+                h ^= zobrist.key(atom_id);
+        }
+        return h;
+    }
+
+    const State& get_precondition_mask() const
+    {
+        return this->precondition_mask;
+    }
+
+    const State& get_negative_precondition_mask() const
+    {
+        return this->negative_precondition_mask;
+    }
+
+    const State& get_add_mask() const
+    {
+        return this->add_mask;
+    }
+
+    const State& get_delete_mask() const
+    {
+        return this->delete_mask;
+    }
+
     bool operator==(const GroundedAction& rhs) const
     {
         if (this->name != rhs.name || this->arg_values.size() != rhs.arg_values.size())
@@ -193,7 +341,7 @@ public:
         string temp = "";
         temp += this->name;
         temp += "(";
-        for (string l : this->arg_values)
+        for (const string& l : this->arg_values)
         {
             temp += l + ",";
         }
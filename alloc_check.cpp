@@ -0,0 +1,167 @@
+// Allocation regression check: counts heap allocations with a replaced operator new and fails
+// if the read accessors of the environment and the grounded actions copy their containers, or if
+// the per-state work of the search loop allocates once its buffers are warm.
+//
+//     clang++ -std=c++17 -O2 -pthread alloc_check.cpp -o alloc_check.out
+//     ./alloc_check.out BlocksTriangle.txt
+//
+// Every getter of the Env, its action schemas and the grounded actions is called once per
+// object; they return const references, so this allocates nothing. A first search registers
+// the states, then every registered state is run through the
+// checks the search loop makes (successor generation, applicability and goal tests, the
+// successor's bits and hash, its registry lookup and the goal-count heuristic) with the
+// allocation counter armed. A second search from a cleared planner reuses the storage of
+// the first, so its allocations must not grow with the number of expansions.
+#define PLANNER_NO_MAIN
+#include "planner.cpp"
+
+#include <new>
+#include <cassert>
+#include <cstdlib>
+
+atomic<long> num_allocations(0);
+
+// Allocations allowed in a repeated search besides one successor state per applicable action of
+// the widest expansion: the other local buffers of a_star_search
+const long SEARCH_BUFFER_ALLOCATIONS = 32;
+
+// noinline keeps GCC from pairing the inlined malloc and free with new and delete expressions
+__attribute__((noinline)) void* operator new(size_t size)
+{
+    num_allocations.fetch_add(1, memory_order_relaxed);
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+        throw bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void* p, size_t) noexcept
+{
+    free(p);
+}
+
+// Allocations of reading every container of the environment and the grounded actions
+long check_accessors(const Env& env, const vector<GroundedAction>& actions, long& num_calls)
+{
+    long before = num_allocations.load();
+    size_t sink = env.get_symbols().size() + env.get_atoms().num_atoms();
+    for (const Action& a : env.get_actions())
+    {
+        sink += a.get_name().size() + a.get_args().size() + a.get_preconditions().size() + a.get_effects().size();
+        for (const Condition& c : a.get_preconditions())
+            sink += c.get_predicate().size() + c.get_args().size() + c.get_truth();
+        num_calls++;
+    }
+    for (const GroundedAction& ga : actions)
+    {
+        sink += ga.get_name().size() + ga.get_arg_values().size() + ga.get_preconditions().size() + ga.get_effects().size();
+        sink += ga.get_precondition_atoms().size() + ga.get_negative_precondition_atoms().size();
+        sink += ga.get_add_atoms().size() + ga.get_delete_atoms().size() + ga.get_add_mask().num_words();
+        for (const GroundedCondition& gc : ga.get_preconditions())
+            sink += gc.get_predicate().size() + gc.get_arg_values().size() + gc.get_atom_id();
+        num_calls++;
+    }
+    long allocations = num_allocations.load() - before;
+    if (sink == 0)
+        cout << sink;
+    return allocations;
+}
+
+// Allocations of the search loop's checks on every registered state, with warm buffers
+long check_states(SymbolicPlanner& planner, long& num_calls, size_t& max_applicable)
+{
+    const GroundedTask& task = *planner.get_task();
+    State state(task.num_atoms);
+    State next_state(task.num_atoms);
+    vector<int> applicable;
+    applicable.reserve(task.actions.size());
+    size_t num_states = planner.state_registry.size();
+
+    long before = num_allocations.load();
+    long sink = 0;
+    for (size_t id = 0; id < num_states; id++)
+    {
+        planner.state_registry.get_state(id, state);
+        uint64_t hash = planner.state_registry.get_hash(id);
+        sink += planner.goal_reached(state) + planner.simple_heur(state);
+        applicable.clear();
+        task.successor_generator.generate_applicable_actions(state, applicable);
+        max_applicable = max(max_applicable, applicable.size());
+        for (size_t a = 0; a < task.actions.size(); a++)
+        {
+            const GroundedAction& ga = task.actions[a];
+            if (!planner.is_action_valid(state, ga))
+                continue;
+            next_state = state;
+            next_state.apply(ga.get_add_mask(), ga.get_delete_mask());
+            // the successors of expanded states are registered, so this is a lookup
+            if (planner.node_info[id].closed)
+                sink += planner.state_registry.insert_state(next_state, ga.successor_hash(hash, state, task.zobrist)).second;
+            num_calls++;
+        }
+    }
+    long allocations = num_allocations.load() - before;
+    if (sink < 0)
+        cout << sink;
+    return allocations;
+}
+
+int main(int argc, char* argv[])
+{
+    char* filename = (char*)("BlocksTriangle.txt");
+    if (argc > 1)
+        filename = argv[1];
+
+    Env* env = create_env(filename);
+    SymbolicPlanner planner(env);
+    planner.compute_all_grounded_actions();
+
+    long num_accessor_calls = 0;
+    long accessor_allocations = check_accessors(*env, planner.get_grounded_actions(), num_accessor_calls);
+    cout << "Actions and schemas read: " << num_accessor_calls << ", allocations: " << accessor_allocations << endl;
+
+    // warm-up: register the states and grow every buffer of the search
+    planner.search();
+    long expanded = planner.num_expanded;
+
+    long num_calls = 0;
+    size_t max_applicable = 0;
+    long state_allocations = check_states(planner, num_calls, max_applicable);
+    cout << "States: " << planner.state_registry.size() << ", successors checked: " << num_calls
+         << ", allocations: " << state_allocations << endl;
+
+    // the search loop again, without the plan extraction
+    planner.num_expanded = 0;
+    long before = num_allocations.load();
+    planner.init_start_node();
+    planner.a_star_search();
+    long search_allocations = num_allocations.load() - before;
+    cout << "Second search: " << planner.num_expanded << " expansions, allocations: " << search_allocations << endl;
+
+    // the second search only allocates the local buffers of a_star_search, not per expansion
+    bool ok = accessor_allocations == 0 && state_allocations == 0 && planner.num_expanded == expanded && search_allocations <= SEARCH_BUFFER_ALLOCATIONS + (long)max_applicable;
+    assert(ok);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    delete env;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+using namespace std;
+
+// Monotonic pool of fixed-size records (stride T's each) used as per-search storage for states
+// and search nodes. Records live in chunks that never move and double in size (64, 128, 256...
+// records), so growing the pool does not copy and small pools stay small. clear() releases all
+// records in O(1) while keeping the chunks for the next search.
+// T must be trivially destructible, records are only reset by value-assignment.
+template <typename T>
+class RecordPool
+{
+private:
+    static const int FIRST_CHUNK_BITS = 6;
+
+    size_t stride;
+    vector<unique_ptr<T[]>> chunks;
+    size_t num_records = 0;
+
+public:
+    RecordPool(size_t stride = 1)
+    {
+        this->stride = stride;
+    }
+
+    // Chunk c holds records [2^(c+6) - 64, 2^(c+7) - 64)
+    T* record(size_t i)
+    {
+        size_t j = i + ((size_t)1 << FIRST_CHUNK_BITS);
+        int bit = 63 - __builtin_clzll(j);
+        return &this->chunks[bit - FIRST_CHUNK_BITS][(j - ((size_t)1 << bit)) * this->stride];
+    }
+
+    const T* record(size_t i) const
+    {
+        return const_cast<RecordPool*>(this)->record(i);
+    }
+
+    // Element i of a pool with stride 1
+    T& operator[](size_t i)
+    {
+        return *record(i);
+    }
+
+    const T& operator[](size_t i) const
+    {
+        return *record(i);
+    }
+
+    // Append a record of value-initialized T's and return its index
+    size_t add()
+    {
+        size_t i = this->num_records++;
+        size_t j = i + ((size_t)1 << FIRST_CHUNK_BITS);
+        if ((j & (j - 1)) == 0 && (size_t)(63 - __builtin_clzll(j) - FIRST_CHUNK_BITS) == this->chunks.size())
+            this->chunks.push_back(unique_ptr<T[]>(new T[j * this->stride]));
+        T* r = record(i);
+        fill(r, r + this->stride, T());
+        return i;
+    }
+
+    // Grow to n records, like vector::resize for a pool that only grows
+    void resize(size_t n)
+    {
+        while (this->num_records < n)
+            add();
+    }
+
+    size_t size() const
+    {
+        return this->num_records;
+    }
+
+    // Drop all records in O(1), the chunks are reused
+    void clear()
+    {
+        this->num_records = 0;
+    }
+
+    // Drop all records and free the chunks
+    void release()
+    {
+        this->chunks.clear();
+        this->num_records = 0;
+    }
+};
@@ -0,0 +1,189 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <list>
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std;
+
+// Hashes a packed atom key (predicate id followed by argument ids)
+struct AtomKeyHasher
+{
+    size_t operator()(const vector<int>& key) const
+    {
+        size_t h = key.size();
+        for (int k : key)
+            h ^= hash<int>{}(k) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+// Interning table for symbols, predicates and grounded atoms.
+// Every symbol and predicate name gets a dense integer id, and every grounded atom
+// (predicate id + argument ids) gets a dense atom id, so the planner can work on ints
+// instead of strings once the environment is built.
+// Names are looked up by string_view (e.g. straight from the parser's mapped file) and only
+// copied when they are new. The name maps point into the deques, whose elements never move, so
+// the table cannot be copied.
+class AtomTable
+{
+private:
+    unordered_map<string_view, int> symbol_ids;
+    deque<string> symbol_names;
+    unordered_map<string_view, int> predicate_ids;
+    deque<string> predicate_names;
+
+    unordered_map<vector<int>, int, AtomKeyHasher> atom_ids; // packed key, atom id
+    vector<vector<int>> atom_keys; // atom id, packed key
+    vector<int> key_buffer; // key being interned, only copied for a new atom
+    vector<int> arg_buffer; // argument ids being interned
+
+    static int intern_name(string_view name, unordered_map<string_view, int>& ids, deque<string>& names)
+    {
+        auto it = ids.find(name);
+        if (it != ids.end())
+            return it->second;
+        int id = names.size();
+        names.emplace_back(name);
+        ids[names.back()] = id;
+        return id;
+    }
+
+    static int find_name(string_view name, const unordered_map<string_view, int>& ids)
+    {
+        auto it = ids.find(name);
+        if (it == ids.end())
+            return -1;
+        return it->second;
+    }
+
+public:
+    AtomTable() {}
+    AtomTable(const AtomTable&) = delete;
+    AtomTable& operator=(const AtomTable&) = delete;
+
+    int intern_symbol(string_view symbol)
+    {
+        return intern_name(symbol, this->symbol_ids, this->symbol_names);
+    }
+
+    // Symbol id, or -1 if it was never interned
+    int find_symbol(string_view symbol) const
+    {
+        return find_name(symbol, this->symbol_ids);
+    }
+
+    int intern_predicate(string_view predicate)
+    {
+        return intern_name(predicate, this->predicate_ids, this->predicate_names);
+    }
+
+    // Predicate id, or -1 if it was never interned
+    int find_predicate(string_view predicate) const
+    {
+        return find_name(predicate, this->predicate_ids);
+    }
+
+    // Returns the atom id of predicate(args), creating it if needed
+    int intern_atom(const string& predicate, const list<string>& args)
+    {
+        int predicate_id = intern_predicate(predicate);
+        this->arg_buffer.clear();
+        for (const string& arg : args)
+            this->arg_buffer.push_back(intern_symbol(arg));
+        return intern_atom(predicate_id, this->arg_buffer);
+    }
+
+    // Same with names given as views, e.g. into a mapped problem file
+    int intern_atom(string_view predicate, const vector<string_view>& args)
+    {
+        int predicate_id = intern_predicate(predicate);
+        this->arg_buffer.clear();
+        for (string_view arg : args)
+            this->arg_buffer.push_back(intern_symbol(arg));
+        return intern_atom(predicate_id, this->arg_buffer);
+    }
+
+    // Returns the atom id of predicate(args) given as ids, creating it if needed
+    int intern_atom(int predicate, const vector<int>& args)
+    {
+        this->key_buffer.clear();
+        this->key_buffer.push_back(predicate);
+        this->key_buffer.insert(this->key_buffer.end(), args.begin(), args.end());
+
+        auto it = this->atom_ids.find(this->key_buffer);
+        if (it != this->atom_ids.end())
+            return it->second;
+        int id = this->atom_keys.size();
+        this->atom_ids[this->key_buffer] = id;
+        this->atom_keys.push_back(this->key_buffer);
+        return id;
+    }
+
+    // Returns the atom id of predicate(args), or -1 if it was never interned
+    int find_atom(int predicate, const vector<int>& args) const
+    {
+        vector<int> key;
+        key.reserve(args.size() + 1);
+        key.push_back(predicate);
+        key.insert(key.end(), args.begin(), args.end());
+
+        auto it = this->atom_ids.find(key);
+        if (it == this->atom_ids.end())
+            return -1;
+        return it->second;
+    }
+
+    int num_symbols() const
+    {
+        return this->symbol_names.size();
+    }
+
+    int num_predicates() const
+    {
+        return this->predicate_names.size();
+    }
+
+    int num_atoms() const
+    {
+        return this->atom_keys.size();
+    }
+
+    const string& symbol_name(int id) const
+    {
+        return this->symbol_names[id];
+    }
+
+    const string& predicate_name(int id) const
+    {
+        return this->predicate_names[id];
+    }
+
+    int atom_predicate(int atom) const
+    {
+        return this->atom_keys[atom][0];
+    }
+
+    // Predicate id followed by argument symbol ids
+    const vector<int>& atom_key(int atom) const
+    {
+        return this->atom_keys[atom];
+    }
+
+    string atom_to_string(int atom) const
+    {
+        const vector<int>& key = this->atom_keys[atom];
+        string temp = this->predicate_names[key[0]];
+        temp += "(";
+        for (size_t i = 1; i < key.size(); i++)
+        {
+            temp += this->symbol_names[key[i]];
+            if (i + 1 < key.size())
+                temp += ",";
+        }
+        temp += ")";
+        return temp;
+    }
+};
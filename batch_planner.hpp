@@ -0,0 +1,346 @@
+#include <string>
+#include <vector>
+#include <list>
+#include <set>
+#include <map>
+#include <memory>
+#include <cstring>
+
+using namespace std;
+
+// One query of a BatchPlanner: an initial state and a goal as atom ids of its task
+struct PlanningQuery
+{
+    vector<int> initial_atoms;
+    vector<int> goal_atoms;
+    SearchOptions options; // the BatchPlanner's unless changed, eval_threads is ignored
+    bool unreachable_goal = false; // a goal atom is not in the task and not initially true
+    bool out_of_task = false; // the initial state may reach actions the grounding left out
+};
+
+struct PlanningResult
+{
+    SearchStatus status = SEARCHING;
+    list<GroundedAction> plan;
+    int expanded = 0;
+    long generated = 0;
+    double search_time = 0; // seconds
+    bool cached = false; // the plan came from the plan cache
+    string error; // why the query was not searched, for the status ERROR
+};
+
+// Plans many queries on one grounded problem. The problem is grounded once when the BatchPlanner
+// is created (or read from task_cache). Queries are searched by SymbolicPlanners that share the
+// grounded actions, successor generator and relaxed heuristic structure. There is one such search
+// context per thread solving queries; a query only retargets its goal mask and heuristic goal, and
+// the state registry, nodes and open list keep their storage between queries. solve runs a batch
+// of queries on a thread pool:
+//
+//     BatchPlanner batch(env, options, 4);
+//     vector<PlanningQuery> queries = { batch.query("On(A,B), Clear(A), ...", "On(B,A)"), ... };
+//     vector<PlanningResult> results = batch.solve(queries);
+//
+// Actions are grounded by relaxed reachability from the environment's initial state, so actions that
+// only become applicable from other initial states are missing. A query is only searched if its
+// initial state is covered by the grounding: all its facts are reachable from the environment's
+// initial state, and it keeps the initial facts that pruned actions (Grounder::get_static_blockers).
+// Everything reachable from it is then grounded too. Other queries get the status OUT_OF_TASK,
+// never UNSOLVABLE. Give the problem file an initial state with the union of the facts the queries
+// start from to ground for all of them.
+// solve(query) may be called from several threads at once, the batch solve must not.
+//
+// With a plan cache, repeated queries (same initial state, goal and search settings) return the
+// stored plan without searching, and searches are seeded with the goal distances of earlier optimal
+// plans and the heuristic values of earlier searches, see PlanCache.
+class BatchPlanner
+{
+private:
+    Env* env;
+    SearchOptions options;
+    shared_ptr<GroundedTask> task;
+    ThreadPool pool;
+    unique_ptr<PlanCache> plan_cache; // nullptr if disabled
+    State reachable; // atoms reachable from the environment's initial state in the relaxed task
+    mutex context_mutex;
+    vector<unique_ptr<SymbolicPlanner>> free_contexts; // search contexts not used by a thread
+
+    // A search context for the calling thread, made on first use by a new thread. options are
+    // those of the query with eval_threads 1, so a context never starts an evaluation pool.
+    unique_ptr<SymbolicPlanner> acquire_context(const PlanningQuery& query, const SearchOptions& options)
+    {
+        {
+            lock_guard<mutex> lock(this->context_mutex);
+            if (!this->free_contexts.empty())
+            {
+                unique_ptr<SymbolicPlanner> planner = move(this->free_contexts.back());
+                this->free_contexts.pop_back();
+                return planner;
+            }
+        }
+        return unique_ptr<SymbolicPlanner>(new SymbolicPlanner(this->task, query.initial_atoms, query.goal_atoms, options));
+    }
+
+    void release_context(unique_ptr<SymbolicPlanner> planner)
+    {
+        lock_guard<mutex> lock(this->context_mutex);
+        this->free_contexts.push_back(move(planner));
+    }
+
+    // Search settings that change which plan is found, the limits included: a search cut short by
+    // them may return a worse plan, or none
+    static uint64_t search_config(const SearchOptions& options)
+    {
+        uint64_t config = ((uint64_t)options.engine << 48) ^ ((uint64_t)options.heuristic << 40) ^ ((uint64_t)options.goal_limit << 20) ^ (uint64_t)options.weight;
+        uint64_t time_limit;
+        memcpy(&time_limit, &options.time_limit, sizeof(time_limit));
+        config = PlanCache::combine(config, options.node_limit);
+        config = PlanCache::combine(config, time_limit);
+        return PlanCache::combine(config, options.memory_limit);
+    }
+
+    // Apply the actions of a cached plan to initial, false unless they are applicable and reach the goal
+    bool replay(State state, const vector<int>& actions, const vector<int>& goal_atoms, list<GroundedAction>& plan) const
+    {
+        plan.clear();
+        for (int a : actions)
+        {
+            if (a < 0 || a >= (int)this->task->actions.size())
+                return false;
+            const GroundedAction& ga = this->task->actions[a];
+            if (!state.contains(ga.get_precondition_mask()) || state.intersects(ga.get_negative_precondition_mask()))
+                return false;
+            state.apply(ga.get_add_mask(), ga.get_delete_mask());
+            plan.push_back(ga);
+        }
+        return state.contains(State(this->task->num_atoms, goal_atoms));
+    }
+
+    // Store the plan of a finished search, and the goal distances along it if it is optimal. RWA*
+    // returns its best plan so far when a limit stops it; that plan depends on timing and is not
+    // stored.
+    void store_search(const SymbolicPlanner& planner, const State& initial, uint64_t goal_key, uint64_t plan_key) const
+    {
+        if (planner.status != SOLVED || (planner.options.engine == RWASTAR && !planner.plan_proven_optimal))
+            return;
+        this->plan_cache->store_plan(plan_key, planner.plan_actions);
+        if (!planner.options.optimal())
+            return;
+        vector<State> states = { initial };
+        vector<uint64_t> hashes = { this->task->zobrist.hash_state(initial) };
+        for (int a : planner.plan_actions)
+        {
+            const GroundedAction& ga = this->task->actions[a];
+            hashes.push_back(ga.successor_hash(hashes.back(), states.back(), this->task->zobrist));
+            states.push_back(states.back());
+            states.back().apply(ga.get_add_mask(), ga.get_delete_mask());
+        }
+        this->plan_cache->store_distances(states, hashes, goal_key);
+    }
+
+    // Atom id of a condition, -1 if the task has no such atom
+    int find_atom(const GroundedCondition& gc) const
+    {
+        const AtomTable& atoms = this->env->get_atoms();
+        int predicate = atoms.find_predicate(gc.get_predicate());
+        if (predicate < 0)
+            return -1;
+        vector<int> args;
+        for (const string& arg : gc.get_arg_values())
+        {
+            args.push_back(atoms.find_symbol(arg));
+            if (args.back() < 0)
+                return -1;
+        }
+        return atoms.find_atom(predicate, args);
+    }
+
+public:
+    // Ground env for queries run with options on num_threads threads (the caller is one of them),
+    // with a plan cache of at most plan_cache_bytes (0 for none)
+    BatchPlanner(Env* env, const SearchOptions& options = SearchOptions(), int num_threads = 1, size_t plan_cache_bytes = 0)
+        : pool(num_threads)
+    {
+        this->env = env;
+        this->options = options;
+        this->options.eval_threads = 1; // the queries are already run in parallel
+        SymbolicPlanner planner(env, this->options);
+        if (task_cache.hit())
+            planner.set_grounded_actions(task_cache.grounded_actions(), task_cache.static_blockers());
+        else
+        {
+            planner.compute_all_grounded_actions();
+            if (task_cache.enabled())
+                task_cache.store(*env, planner.get_grounded_actions(), planner.get_task()->static_blockers);
+        }
+        this->task = planner.get_task();
+        if (plan_cache_bytes > 0)
+            this->plan_cache.reset(new PlanCache(plan_cache_bytes, this->task->num_atoms));
+
+        // every grounded action is reachable, so its add effects are too
+        this->reachable = State(this->task->num_atoms, env->get_initial_atoms());
+        for (const GroundedAction& ga : this->task->actions)
+            this->reachable.apply_relaxed(ga.get_add_mask());
+    }
+
+    const GroundedTask& get_task() const
+    {
+        return *this->task;
+    }
+
+    int num_threads() const
+    {
+        return this->pool.size();
+    }
+
+    // nullptr without a plan cache
+    PlanCache* get_plan_cache() const
+    {
+        return this->plan_cache.get();
+    }
+
+    // Query from condition lists in the problem format, e.g. ("On(A,B), Clear(A)", "On(B,A)"), applied
+    // in order like the problem's initial and goal conditions. Throws ParseError, and invalid_argument
+    // for a symbol the problem does not have. Initial facts of
+    // predicates the problem never mentions cannot enable any action and are dropped; other initial
+    // facts outside the grounding make the query out of the task. In a covered query, a goal fact the
+    // task does not know makes the query unsolvable unless the initial state has it.
+    PlanningQuery query(const string& initial, const string& goal) const
+    {
+        set<int> initial_atoms;
+        set<int> goal_atoms;
+        map<string, bool> unknown_initial; // fact, its predicate is known
+        set<string> unknown_goal;
+        for (int part = 0; part < 2; part++)
+        {
+            const string& text = part == 0 ? initial : goal;
+            ProblemParser parser(part == 0 ? "initial state" : "goal", text.data(), text.data() + text.size(), this->env);
+            set<int>& atoms = part == 0 ? initial_atoms : goal_atoms;
+            for (const GroundedCondition& gc : parser.parse_conditions())
+            {
+                for (const string& arg : gc.get_arg_values())
+                {
+                    if (this->env->get_atoms().find_symbol(arg) < 0)
+                        throw invalid_argument(string(part == 0 ? "initial state" : "goal") + ": unknown symbol " + arg + " in " + gc.toString());
+                }
+                int atom_id = find_atom(gc);
+                if (atom_id >= 0 && gc.get_truth())
+                    atoms.insert(atom_id);
+                else if (atom_id >= 0)
+                    atoms.erase(atom_id);
+                else if (part == 0 && gc.get_truth())
+                    unknown_initial[gc.toString()] = this->env->get_atoms().find_predicate(gc.get_predicate()) >= 0;
+                else if (part == 0)
+                    unknown_initial.erase(gc.toString());
+                else if (gc.get_truth())
+                    unknown_goal.insert(gc.toString());
+                else
+                    unknown_goal.erase(gc.toString());
+            }
+        }
+
+        PlanningQuery q;
+        q.options = this->options;
+        q.initial_atoms.assign(initial_atoms.begin(), initial_atoms.end());
+        q.goal_atoms.assign(goal_atoms.begin(), goal_atoms.end());
+        for (const string& fact : unknown_goal)
+        {
+            if (!unknown_initial.count(fact))
+                q.unreachable_goal = true;
+        }
+
+        // the query is covered if everything reachable from its initial state was grounded
+        for (const auto& fact : unknown_initial)
+        {
+            if (fact.second)
+                q.out_of_task = true;
+        }
+        for (int atom_id : initial_atoms)
+        {
+            if (!this->reachable.test(atom_id))
+                q.out_of_task = true;
+        }
+        for (int atom_id : this->task->static_blockers)
+        {
+            if (!initial_atoms.count(atom_id))
+                q.out_of_task = true;
+        }
+        return q;
+    }
+
+    // Plan one query on the calling thread. Invalid search options (SearchOptions::validate) give
+    // the status ERROR.
+    PlanningResult solve(const PlanningQuery& query)
+    {
+        PlanningResult result;
+        try
+        {
+            query.options.validate();
+        }
+        catch (const invalid_argument& e)
+        {
+            result.status = ERROR;
+            result.error = e.what();
+            return result;
+        }
+        if (query.out_of_task)
+        {
+            result.status = OUT_OF_TASK;
+            return result;
+        }
+        if (query.unreachable_goal)
+        {
+            result.status = UNSOLVABLE;
+            return result;
+        }
+        SearchOptions options = query.options;
+        options.eval_threads = 1;
+        double start = wall_clock_seconds();
+
+        State initial(this->task->num_atoms, query.initial_atoms);
+        vector<int> goal_atoms = query.goal_atoms;
+        sort(goal_atoms.begin(), goal_atoms.end());
+        goal_atoms.erase(unique(goal_atoms.begin(), goal_atoms.end()), goal_atoms.end());
+        uint64_t goal_key = PlanCache::goal_key(goal_atoms);
+        uint64_t plan_key = 0;
+        if (this->plan_cache)
+        {
+            plan_key = PlanCache::plan_key(this->task->zobrist.hash_state(initial), goal_key, search_config(options));
+            vector<int> actions;
+            if (this->plan_cache->find_plan(plan_key, actions) && replay(initial, actions, goal_atoms, result.plan))
+            {
+                this->plan_cache->plan_hits++;
+                result.status = SOLVED;
+                result.cached = true;
+                result.search_time = wall_clock_seconds() - start;
+                return result;
+            }
+            this->plan_cache->plan_misses++;
+        }
+
+        unique_ptr<SymbolicPlanner> context = acquire_context(query, options);
+        SymbolicPlanner& planner = *context;
+        planner.set_query(query.initial_atoms, goal_atoms, options);
+        planner.plan_cache = this->plan_cache.get();
+        planner.goal_key = goal_key;
+        result.plan = planner.search();
+        result.search_time = wall_clock_seconds() - start;
+        result.status = planner.status;
+        result.expanded = planner.num_expanded;
+        result.generated = planner.num_generated;
+        if (this->plan_cache)
+            store_search(planner, initial, goal_key, plan_key);
+        release_context(move(context));
+        return result;
+    }
+
+    // Plan all queries on the pool, results in query order
+    vector<PlanningResult> solve(const vector<PlanningQuery>& queries)
+    {
+        vector<PlanningResult> results(queries.size());
+        this->pool.parallel_for(queries.size(), [&](size_t i, int)
+        {
+            results[i] = solve(queries[i]);
+        });
+        return results;
+    }
+};
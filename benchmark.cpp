@@ -0,0 +1,477 @@
+// Benchmark harness: generates scalable Blocks, BlocksTriangle and FireExtinguisher problems in the
+// planner's text format, runs every engine/heuristic combination on them and reports one row per
+// run as CSV or JSON on stdout. Each run is forked so that its peak memory is measured on its own.
+//
+//     clang++ -std=c++17 -O2 -pthread benchmark.cpp -o benchmark.out
+//     ./benchmark.out --blocks 4,5,6 --fire 5 --engines astar,gbfs --heuristics hmax,ff --format json
+#define PLANNER_NO_MAIN
+#include "planner.cpp"
+
+#include <random>
+#include <map>
+#include <tuple>
+#include <sstream>
+#include <unistd.h>
+#include <sys/wait.h>
+
+struct BenchmarkOptions
+{
+    vector<int> blocks = { 4, 5, 6 }; // number of blocks
+    vector<pair<int, int>> triangle = { { 4, 1 }, { 5, 2 } }; // blocks, triangles
+    vector<int> fire = { 3, 5, 8 }; // locations besides the water and the fire
+    vector<SearchEngine> engines = { ASTAR, GBFS };
+    vector<int> heuristics = { 1, 3, 4, 5 };
+    unsigned seed = 1;
+    double time_limit = 10;
+    long memory_limit = -1;
+    string format = "csv";
+    string instance_dir = "/tmp";
+};
+
+struct BenchmarkResult
+{
+    string domain;
+    string size;
+    string engine;
+    string heuristic;
+    string status = "CRASHED";
+    long plan_length = -1;
+    long grounded_actions = 0;
+    double grounding_time = 0;
+    double search_time = 0;
+    long expanded = 0;
+    long generated = 0;
+    long peak_rss_kb = 0;
+};
+
+string join(const vector<string>& items, const string& separator)
+{
+    string s;
+    for (size_t i = 0; i < items.size(); i++)
+        s += (i > 0 ? separator : "") + items[i];
+    return s;
+}
+
+// Random towers of the given objects: on[x] is what x stands on ("Table" for the bottom)
+map<string, string> random_towers(const vector<string>& objects, mt19937& rng)
+{
+    vector<string> order = objects;
+    shuffle(order.begin(), order.end(), rng);
+    map<string, string> on;
+    string below = "Table";
+    for (const string& x : order)
+    {
+        on[x] = below;
+        below = rng() % 3 == 0 ? "Table" : x; // start a new tower a third of the time
+    }
+    return on;
+}
+
+// On(x,y) atoms of the towers, plus Clear(x) for every tower top
+vector<string> tower_atoms(const map<string, string>& on, bool with_clear)
+{
+    vector<string> atoms;
+    set<string> covered;
+    for (const auto& entry : on)
+    {
+        atoms.push_back("On(" + entry.first + "," + entry.second + ")");
+        covered.insert(entry.second);
+    }
+    if (with_clear)
+    {
+        for (const auto& entry : on)
+        {
+            if (!covered.count(entry.first))
+                atoms.push_back("Clear(" + entry.first + ")");
+        }
+    }
+    return atoms;
+}
+
+// n blocks, random start and goal towers (Blocks.txt)
+string generate_blocks(int n, mt19937& rng)
+{
+    vector<string> blocks;
+    for (int i = 0; i < n; i++)
+        blocks.push_back("B" + to_string(i));
+
+    vector<string> initial = tower_atoms(random_towers(blocks, rng), true);
+    for (const string& b : blocks)
+        initial.push_back("Block(" + b + ")");
+    vector<string> goal = tower_atoms(random_towers(blocks, rng), false);
+
+    ostringstream out;
+    out << "Symbols: " << join(blocks, ",") << ",Table" << endl
+        << "Initial conditions: " << join(initial, ", ") << endl
+        << "Goal conditions: " << join(goal, ", ") << endl << endl
+        << "Actions:" << endl
+        << "        MoveToTable(b,x)" << endl
+        << "        Preconditions: On(b,x), Clear(b), Block(b), Block(x)" << endl
+        << "        Effects: On(b,Table), Clear(x), !On(b,x)" << endl << endl
+        << "        Move(b,x,y)" << endl
+        << "        Preconditions: On(b,x), Clear(b), Clear(y), Block(b), Block(y)" << endl
+        << "        Effects: On(b,y), Clear(x), !On(b,x), !Clear(y)" << endl;
+    return out.str();
+}
+
+// n blocks and m triangles that nothing can stand on (BlocksTriangle.txt). The goal is the
+// position of the triangles and of every other block in random goal towers.
+string generate_blocks_triangle(int n, int m, mt19937& rng)
+{
+    vector<string> blocks;
+    vector<string> triangles;
+    for (int i = 0; i < n; i++)
+        blocks.push_back("B" + to_string(i));
+    for (int i = 0; i < m; i++)
+        triangles.push_back("T" + to_string(i));
+
+    // triangles go on top of random towers
+    auto place = [&](map<string, string> on)
+    {
+        set<string> covered;
+        for (const auto& entry : on)
+            covered.insert(entry.second);
+        vector<string> tops;
+        for (const string& b : blocks)
+        {
+            if (!covered.count(b))
+                tops.push_back(b);
+        }
+        shuffle(tops.begin(), tops.end(), rng);
+        for (size_t i = 0; i < triangles.size(); i++)
+            on[triangles[i]] = i < tops.size() ? tops[i] : "Table";
+        return on;
+    };
+
+    vector<string> initial = tower_atoms(place(random_towers(blocks, rng)), true);
+    vector<string> symbols = blocks;
+    symbols.insert(symbols.end(), triangles.begin(), triangles.end());
+    for (const string& b : blocks)
+        initial.push_back("Block(" + b + ")");
+    for (const string& t : triangles)
+        initial.push_back("Triangle(" + t + ")");
+    for (const string& x : symbols)
+        initial.push_back("NotTable(" + x + ")");
+
+    map<string, string> goal_on = place(random_towers(blocks, rng));
+    vector<string> goal;
+    int i = 0;
+    for (const string& atom : tower_atoms(goal_on, false))
+    {
+        if (atom[3] == 'T' || i++ % 2 == 0)
+            goal.push_back(atom);
+    }
+
+    ostringstream out;
+    out << "Symbols: " << join(symbols, ", ") << ", Table" << endl
+        << "Initial conditions: " << join(initial, ", ") << endl
+        << "Goal conditions: " << join(goal, ", ") << endl << endl
+        << "Actions:" << endl
+        << "        MoveToTable(x,y)" << endl
+        << "        Preconditions: On(x,y), Clear(x), NotTable(x), NotTable(y), Block(y)" << endl
+        << "        Effects: On(x,Table), Clear(y), !On(x,y)" << endl << endl
+        << "        Move(x,y,z)" << endl
+        << "        Preconditions: On(x,y), Block(z), Clear(z), Clear(x), NotTable(x), NotTable(z)" << endl
+        << "        Effects: Clear(y), On(x,z), !Clear(z), !On(x,y)" << endl;
+    return out.str();
+}
+
+// FireExtinguisher.txt with m locations L0..L(m-1) besides the water W and the fire F
+string generate_fire_extinguisher(int m)
+{
+    vector<string> locations;
+    for (int i = 0; i < m; i++)
+        locations.push_back("L" + to_string(i));
+    locations.push_back("W");
+    locations.push_back("F");
+
+    vector<string> initial = { "Quad(Q)", "Rob(R)", "At(Q," + locations[min(1, m - 1)] + ")", "At(R,L0)",
+        "HighCharge(Q)", "InAir(Q)", "EmptyTank(Q)" };
+    for (const string& l : locations)
+        initial.push_back("Loc(" + l + ")");
+    initial.push_back("Fire(F)");
+
+    ostringstream out;
+    out << "Symbols: " << join(locations, ",") << ",Q,R" << endl
+        << "Initial conditions: " << join(initial, ", ") << endl
+        << "Goal conditions: ExtThree(F)" << endl << endl
+        << "Actions:" << endl
+        << "        MoveToLoc(x,y)" << endl
+        << "        Preconditions: Loc(x), Loc(y), At(R,x), InAir(Q)" << endl
+        << "        Effects: At(R,y), !At(R,x)" << endl << endl
+        << "        MoveTogether(x,y)" << endl
+        << "        Preconditions: Loc(x), Loc(y), At(R,x), At(Q,x), OnRob(Q)" << endl
+        << "        Effects: !At(R,x), !At(Q,x), At(R,y), At(Q,y)" << endl << endl
+        << "        TakeOffFromRob(z)" << endl
+        << "        Preconditions: Loc(z), At(R,z), At(Q,z), HighCharge(Q), OnRob(Q)" << endl
+        << "        Effects: InAir(Q), !OnRob(Q)" << endl << endl
+        << "        LandOnRob(z)" << endl
+        << "        Preconditions: Loc(z), At(R,z), At(Q,z), InAir(Q)" << endl
+        << "        Effects: !InAir(Q), OnRob(Q)" << endl << endl
+        << "        Charge(x)" << endl
+        << "        Preconditions: Quad(x), LowCharge(x), OnRob(x)" << endl
+        << "        Effects: !LowCharge(x), HighCharge(x)" << endl << endl
+        << "        FillWater(x)" << endl
+        << "        Preconditions: Quad(x), OnRob(x), EmptyTank(x), At(R,W), At(Q,W)" << endl
+        << "        Effects: !EmptyTank(x), FullTank(Q)" << endl << endl
+        << "        PourOnce(x)" << endl
+        << "        Preconditions: Fire(x), At(Q,x), InAir(Q), FullTank(Q), HighCharge(Q)" << endl
+        << "        Effects: ExtOne(x), EmptyTank(Q), !FullTank(Q), LowCharge(Q), !HighCharge(Q)" << endl << endl
+        << "        PourTwice(x)" << endl
+        << "        Preconditions: Fire(x), At(Q,x), InAir(Q), FullTank(Q), HighCharge(Q), ExtOne(x)" << endl
+        << "        Effects: !ExtOne(x), ExtTwo(x), EmptyTank(Q), !FullTank(Q), LowCharge(Q), !HighCharge(Q)" << endl << endl
+        << "        PourThrice(x)" << endl
+        << "        Preconditions: Fire(x), At(Q,x), InAir(Q), FullTank(Q), HighCharge(Q), ExtTwo(x)" << endl
+        << "        Effects: !ExtTwo(x), ExtThree(x), EmptyTank(Q), !FullTank(Q), LowCharge(Q), !HighCharge(Q)" << endl;
+    return out.str();
+}
+
+// Plan the problem in filename and fill the measured fields of result (runs in the child)
+void run_planner(const string& filename, const SearchOptions& options, BenchmarkResult& result)
+{
+    Env* env = create_env((char*)filename.c_str());
+    SymbolicPlanner planner(env, options);
+
+    double start = wall_clock_seconds();
+    planner.compute_all_grounded_actions();
+    double grounded = wall_clock_seconds();
+    list<GroundedAction> plan = planner.search();
+    double searched = wall_clock_seconds();
+
+    result.status = status_name(planner.status);
+    if (planner.status == SOLVED || !plan.empty())
+        result.plan_length = plan.size();
+    result.grounded_actions = planner.get_grounded_actions().size();
+    result.grounding_time = grounded - start;
+    result.search_time = searched - grounded;
+    result.expanded = planner.num_expanded;
+    result.generated = planner.num_generated;
+    delete env;
+}
+
+// Run one benchmark in a child process, which reports its fields through a pipe
+BenchmarkResult run_benchmark(const string& filename, const SearchOptions& options, BenchmarkResult result)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        throw runtime_error("cannot create pipe");
+
+    cout.flush();
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fds[0]);
+        run_planner(filename, options, result);
+        ostringstream out;
+        out << result.status << " " << result.plan_length << " " << result.grounded_actions << " "
+            << result.grounding_time << " " << result.search_time << " " << result.expanded << " " << result.generated;
+        string s = out.str();
+        ssize_t written = write(fds[1], s.data(), s.size());
+        close(fds[1]);
+        _exit(written == (ssize_t)s.size() ? 0 : 1);
+    }
+
+    close(fds[1]);
+    string data;
+    char buffer[256];
+    ssize_t n;
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+        data.append(buffer, n);
+    close(fds[0]);
+
+    int wait_status;
+    struct rusage usage;
+    wait4(pid, &wait_status, 0, &usage);
+#ifdef __APPLE__
+    result.peak_rss_kb = usage.ru_maxrss / 1024;
+#else
+    result.peak_rss_kb = usage.ru_maxrss;
+#endif
+
+    istringstream in(data);
+    in >> result.status >> result.plan_length >> result.grounded_actions >> result.grounding_time
+       >> result.search_time >> result.expanded >> result.generated;
+    return result;
+}
+
+void print_result(const BenchmarkResult& r, const string& format, bool first)
+{
+    double rate = r.search_time > 0 ? r.expanded / r.search_time : 0;
+    if (format == "json")
+    {
+        cout << (first ? "[\n" : ",\n")
+             << "  {\"domain\": \"" << r.domain << "\", \"size\": \"" << r.size << "\", \"engine\": \"" << r.engine
+             << "\", \"heuristic\": \"" << r.heuristic << "\", \"status\": \"" << r.status
+             << "\", \"plan_length\": " << r.plan_length << ", \"grounded_actions\": " << r.grounded_actions
+             << ", \"grounding_s\": " << r.grounding_time << ", \"search_s\": " << r.search_time
+             << ", \"expanded\": " << r.expanded << ", \"generated\": " << r.generated
+             << ", \"expansions_per_s\": " << rate << ", \"peak_rss_kb\": " << r.peak_rss_kb << "}";
+        return;
+    }
+    if (first)
+        cout << "domain,size,engine,heuristic,status,plan_length,grounded_actions,grounding_s,search_s,"
+             << "expanded,generated,expansions_per_s,peak_rss_kb" << endl;
+    cout << r.domain << "," << r.size << "," << r.engine << "," << r.heuristic << "," << r.status << ","
+         << r.plan_length << "," << r.grounded_actions << "," << r.grounding_time << "," << r.search_time << ","
+         << r.expanded << "," << r.generated << "," << rate << "," << r.peak_rss_kb << endl;
+}
+
+void print_usage(const char* program)
+{
+    cout << "Usage: " << program << " [options]" << endl
+         << "  --blocks <n,...>             Blocks instances with n blocks (default 4,5,6)" << endl
+         << "  --triangle <nxm,...>         BlocksTriangle with n blocks and m triangles (default 4x1,5x2)" << endl
+         << "  --fire <m,...>               FireExtinguisher with m extra locations (default 3,5,8)" << endl
+         << "  --engines <e,...>            astar, gbfs, rwastar, hdastar (default astar,gbfs)" << endl
+         << "  --heuristics <h,...>         zero, goalcount, edl, hmax, hadd, ff (default goalcount,hmax,hadd,ff)" << endl
+         << "  --seed <n>                   seed of the random Blocks instances (default 1)" << endl
+         << "  --time-limit <seconds>       per run (default 10)" << endl
+         << "  --memory-limit <MB>          per run" << endl
+         << "  --format <csv|json>          output format (default csv)" << endl
+         << "  --instance-dir <dir>         where the generated problems are written (default /tmp)" << endl
+         << "An empty list (e.g. --fire \"\") skips the domain." << endl;
+}
+
+vector<string> split_list(const string& value)
+{
+    vector<string> items;
+    stringstream in(value);
+    string item;
+    while (getline(in, item, ','))
+    {
+        if (!item.empty())
+            items.push_back(item);
+    }
+    return items;
+}
+
+BenchmarkOptions parse_benchmark_options(int argc, char* argv[])
+{
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        string option = argv[i];
+        if (i + 1 >= argc)
+            throw invalid_argument("missing value for " + option);
+        string value = argv[++i];
+
+        if (option == "--blocks")
+        {
+            options.blocks.clear();
+            for (const string& item : split_list(value))
+                options.blocks.push_back(stoi(item));
+        }
+        else if (option == "--triangle")
+        {
+            options.triangle.clear();
+            for (const string& item : split_list(value))
+            {
+                size_t x = item.find('x');
+                if (x == string::npos)
+                    throw invalid_argument("expected <blocks>x<triangles>, got " + item);
+                options.triangle.push_back(make_pair(stoi(item.substr(0, x)), stoi(item.substr(x + 1))));
+            }
+        }
+        else if (option == "--fire")
+        {
+            options.fire.clear();
+            for (const string& item : split_list(value))
+            {
+                options.fire.push_back(stoi(item));
+                if (options.fire.back() < 1)
+                    throw invalid_argument("FireExtinguisher needs at least 1 location");
+            }
+        }
+        else if (option == "--engines")
+        {
+            options.engines.clear();
+            for (const string& item : split_list(value))
+                options.engines.push_back(parse_engine(item));
+        }
+        else if (option == "--heuristics")
+        {
+            options.heuristics.clear();
+            for (const string& item : split_list(value))
+                options.heuristics.push_back(parse_heuristic(item));
+        }
+        else if (option == "--seed")
+            options.seed = stoul(value);
+        else if (option == "--time-limit")
+            options.time_limit = stod(value);
+        else if (option == "--memory-limit")
+            options.memory_limit = stol(value);
+        else if (option == "--format")
+        {
+            if (value != "csv" && value != "json")
+                throw invalid_argument("unknown format " + value);
+            options.format = value;
+        }
+        else if (option == "--instance-dir")
+            options.instance_dir = value;
+        else
+            throw invalid_argument("unknown option " + option);
+    }
+    return options;
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkOptions options;
+    try
+    {
+        options = parse_benchmark_options(argc, argv);
+    }
+    catch (const exception& e)
+    {
+        cout << "Error: " << e.what() << endl;
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // (domain, size, problem text)
+    vector<tuple<string, string, string>> instances;
+    mt19937 rng(options.seed);
+    for (int n : options.blocks)
+        instances.push_back(make_tuple("Blocks", to_string(n), generate_blocks(n, rng)));
+    for (const pair<int, int>& nm : options.triangle)
+    {
+        string size = to_string(nm.first) + "x" + to_string(nm.second);
+        instances.push_back(make_tuple("BlocksTriangle", size, generate_blocks_triangle(nm.first, nm.second, rng)));
+    }
+    for (int m : options.fire)
+        instances.push_back(make_tuple("FireExtinguisher", to_string(m), generate_fire_extinguisher(m)));
+
+    bool first = true;
+    for (const auto& instance : instances)
+    {
+        string filename = options.instance_dir + "/bench_" + get<0>(instance) + "_" + get<1>(instance) + ".txt";
+        ofstream file(filename);
+        file << get<2>(instance);
+        file.close();
+
+        for (SearchEngine engine : options.engines)
+        {
+            for (int heuristic : options.heuristics)
+            {
+                SearchOptions search;
+                search.engine = engine;
+                search.heuristic = heuristic;
+                search.time_limit = options.time_limit;
+                search.memory_limit = options.memory_limit;
+
+                BenchmarkResult result;
+                result.domain = get<0>(instance);
+                result.size = get<1>(instance);
+                result.engine = engine_names[engine];
+                result.heuristic = heuristic_names[heuristic];
+                cerr << result.domain << " " << result.size << " " << result.engine << " " << result.heuristic << endl;
+
+                print_result(run_benchmark(filename, search, result), options.format, first);
+                first = false;
+            }
+        }
+    }
+    if (options.format == "json")
+        cout << (first ? "[" : "") << "\n]" << endl;
+    return 0;
+}
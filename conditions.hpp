@@ -9,13 +9,14 @@ private:
     string predicate;
     list<string> arg_values;
     bool truth = true;
+    int atom_id = -1; // interned atom id, -1 until interned by the Env
 
 public:
-    GroundedCondition(string predicate, list<string> arg_values, bool truth = true)
+    GroundedCondition(const string& predicate, const list<string>& arg_values, bool truth = true)
     {
         this->predicate = predicate;
         this->truth = truth;  // fixed
-        for (string l : arg_values)
+        for (const string& l : arg_values)
         {
             this->arg_values.push_back(l);
         }
@@ -25,17 +26,18 @@ public:
     {
         this->predicate = gc.predicate;
         this->truth = gc.truth;  // fixed
-        for (string l : gc.arg_values)
+        this->atom_id = gc.atom_id;
+        for (const string& l : gc.arg_values)
         {
             this->arg_values.push_back(l);
         }
     }
 
-    string get_predicate() const
+    const string& get_predicate() const
     {
         return this->predicate;
     }
-    list<string> get_arg_values() const
+    const list<string>& get_arg_values() const
     {
         return this->arg_values;
     }
@@ -45,6 +47,16 @@ public:
         return this->truth;
     }
 
+    int get_atom_id() const
+    {
+        return this->atom_id;
+    }
+
+    void set_atom_id(int atom_id)
+    {
+        this->atom_id = atom_id;
+    }
+
     void flip_truth()
     {
         this->truth = !this->truth;
@@ -58,6 +70,10 @@ public:
 
     bool operator==(const GroundedCondition& rhs) const
     {
+        // interned atoms compare by id
+        if (this->atom_id >= 0 && rhs.atom_id >= 0)
+            return this->atom_id == rhs.atom_id && this->truth == rhs.truth;
+
         if (this->predicate != rhs.predicate || this->arg_values.size() != rhs.arg_values.size())
             return false;
 
@@ -83,7 +99,7 @@ public:
         string temp = "";
         temp += this->predicate;
         temp += "(";
-        for (string l : this->arg_values)
+        for (const string& l : this->arg_values)
         {
             temp += l + ",";
         }
@@ -105,6 +121,8 @@ struct GroundedConditionHasher
 {
     size_t operator()(const GroundedCondition& gcond) const
     {
+        if (gcond.get_atom_id() >= 0)
+            return hash<int>{}(gcond.get_atom_id());
         return hash<string>{}(gcond.toString());
     }
 };
@@ -117,22 +135,22 @@ private:
     bool truth;
 
 public:
-    Condition(string pred, list<string> args, bool truth)
+    Condition(const string& pred, const list<string>& args, bool truth)
     {
         this->predicate = pred;
         this->truth = truth;
-        for (string ar : args)
+        for (const string& ar : args)
         {
             this->args.push_back(ar);
         }
     }
 
-    string get_predicate() const
+    const string& get_predicate() const
     {
         return this->predicate;
     }
 
-    list<string> get_args() const
+    const list<string>& get_args() const
     {
         return this->args;
     }
@@ -178,7 +196,7 @@ public:
             temp += "!";
         temp += this->predicate;
         temp += "(";
-        for (string l : this->args)
+        for (const string& l : this->args)
         {
             temp += l + ",";
         }
@@ -1,55 +1,71 @@
+#include "atoms.hpp"
 #include "actions.hpp"
 
 class Env
 {
 private:
-    unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> initial_conditions;
-    unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> goal_conditions;
+    unordered_set<int> initial_atoms; // atom ids
+    unordered_set<int> goal_atoms;
     unordered_set<Action, ActionHasher, ActionComparator> actions;
     unordered_set<string> symbols;
+    AtomTable atoms;
 
 public:
-    unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> get_initial_conditions()
+    // initial and goal atom ids
+    vector<int> get_initial_atoms() const
     {
-        return this->initial_conditions;
+        return vector<int>(this->initial_atoms.begin(), this->initial_atoms.end());
     }
-    unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> get_goal_conditions()
+    vector<int> get_goal_atoms() const
     {
-        return this->goal_conditions;
+        return vector<int>(this->goal_atoms.begin(), this->goal_atoms.end());
     }
-    void remove_initial_condition(GroundedCondition gc)
+    // Make an interned atom true (add) or false (remove) in the initial state or the goal
+    void set_initial_atom(int atom_id, bool truth)
     {
-        this->initial_conditions.erase(gc);
+        if (truth)
+            this->initial_atoms.insert(atom_id);
+        else
+            this->initial_atoms.erase(atom_id);
     }
-    void add_initial_condition(GroundedCondition gc)
+    void set_goal_atom(int atom_id, bool truth)
     {
-        this->initial_conditions.insert(gc);
+        if (truth)
+            this->goal_atoms.insert(atom_id);
+        else
+            this->goal_atoms.erase(atom_id);
     }
-    void add_goal_condition(GroundedCondition gc)
+    void add_symbol(string_view symbol)
     {
-        this->goal_conditions.insert(gc);
+        this->symbols.emplace(symbol);
+        this->atoms.intern_symbol(symbol);
     }
-    void remove_goal_condition(GroundedCondition gc)
+
+    // Assign the interned atom id to a grounded condition
+    int intern_condition(GroundedCondition& gc)
     {
-        this->goal_conditions.erase(gc);
+        int atom_id = this->atoms.intern_atom(gc.get_predicate(), gc.get_arg_values());
+        gc.set_atom_id(atom_id);
+        return atom_id;
     }
-    void add_symbol(string symbol)
+
+    const AtomTable& get_atoms() const
     {
-        symbols.insert(symbol);
+        return this->atoms;
     }
-    void add_symbols(list<string> symbols)
+
+    AtomTable& get_atoms()
     {
-        for (string l : symbols)
-            this->symbols.insert(l);
+        return this->atoms;
     }
-    void add_action(Action action)
+    void add_action(const Action& action)
     {
         this->actions.insert(action);
     }
 
-    Action get_action(string name)
+    const Action& get_action(const string& name) const
     {
-        for (Action a : this->actions)
+        for (const Action& a : this->actions)
         {
             if (a.get_name() == name)
                 return a;
@@ -57,12 +73,12 @@ public:
         throw runtime_error("Action " + name + " not found!");
     }
 
-    unordered_set<Action, ActionHasher, ActionComparator> get_actions()
+    const unordered_set<Action, ActionHasher, ActionComparator>& get_actions() const
     {
         return this->actions;
     }
 
-    unordered_set<string> get_symbols() const
+    const unordered_set<string>& get_symbols() const
     {
         return this->symbols;
     }
@@ -71,19 +87,19 @@ public:
     {
         os << "***** Environment *****" << endl << endl;
         os << "Symbols: ";
-        for (string s : w.get_symbols())
+        for (const string& s : w.get_symbols())
             os << s + ",";
         os << endl;
         os << "Initial conditions: ";
-        for (GroundedCondition s : w.initial_conditions)
-            os << s;
+        for (int atom_id : w.initial_atoms)
+            os << w.atoms.atom_to_string(atom_id) << " ";
         os << endl;
         os << "Goal conditions: ";
-        for (GroundedCondition g : w.goal_conditions)
-            os << g;
+        for (int atom_id : w.goal_atoms)
+            os << w.atoms.atom_to_string(atom_id) << " ";
         os << endl;
         os << "Actions:" << endl;
-        for (Action g : w.actions)
+        for (const Action& g : w.actions)
             os << g << endl;
         cout << "***** Environment Created! *****" << endl;
         return os;
@@ -0,0 +1,128 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+
+using namespace std;
+
+// Messages buffered per destination before a worker sends them, an idle worker sends all
+const size_t HDA_BATCH_SIZE = 32;
+
+// Lock-free multi-producer single-consumer queue (Vyukov). Producers only swap the head pointer,
+// the single consumer follows next pointers from a stub node, so push never blocks.
+template <typename T>
+class MPSCQueue
+{
+private:
+    struct QueueNode
+    {
+        atomic<QueueNode*> next;
+        T value;
+    };
+
+    atomic<QueueNode*> head; // last pushed node
+    QueueNode* tail; // stub, its successor is the next node to pop
+
+public:
+    MPSCQueue()
+    {
+        QueueNode* stub = new QueueNode();
+        stub->next.store(nullptr, memory_order_relaxed);
+        this->head.store(stub, memory_order_relaxed);
+        this->tail = stub;
+    }
+
+    ~MPSCQueue()
+    {
+        T value;
+        while (pop(value))
+            ;
+        delete this->tail;
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    // Any thread
+    void push(T value)
+    {
+        QueueNode* node = new QueueNode();
+        node->next.store(nullptr, memory_order_relaxed);
+        node->value = move(value);
+        QueueNode* previous = this->head.exchange(node, memory_order_acq_rel);
+        previous->next.store(node, memory_order_release);
+    }
+
+    // Owner thread only, false if the queue is empty
+    bool pop(T& value)
+    {
+        QueueNode* next = this->tail->next.load(memory_order_acquire);
+        if (next == nullptr)
+            return false;
+        value = move(next->value);
+        delete this->tail;
+        this->tail = next;
+        return true;
+    }
+};
+
+// A generated state forwarded to the worker that owns it
+struct HDAMessage
+{
+    uint64_t hash;
+    int g;
+    int action; // action that generated the state
+    int parent_worker;
+    StateID parent_id; // in the registry of parent_worker
+};
+
+// Messages are sent in batches to keep queue traffic low. The words of message i
+// are stored at words[i * num_words, (i + 1) * num_words).
+struct HDAMessageBatch
+{
+    vector<HDAMessage> messages;
+    vector<uint64_t> words;
+};
+
+struct HDANode
+{
+    int g = numeric_limits<int>::max();
+    int h = 0;
+    bool closed = false;
+
+    ParentRecord parent; // parent_id is in the registry of parent_worker
+    int parent_worker = -1;
+};
+
+// One search thread of Hash Distributed A*. It owns the states whose hash maps to it,
+// with its own registry, node records, open list and heuristic scratch buffers.
+struct HDAWorker
+{
+    StateRegistry state_registry;
+    RecordPool<HDANode> node_info; // state id, node
+    BucketOpenList open_list;
+    MPSCQueue<HDAMessageBatch> inbox;
+    vector<HDAMessageBatch> outbox; // destination worker, messages not sent yet
+    RelaxedHeuristic relaxed_heuristic;
+    long num_expanded = 0;
+    long num_generated = 0;
+    bool active = true;
+};
+
+// State shared by all HDA* workers
+struct HDAShared
+{
+    // Number of active workers plus messages in flight. A worker only becomes active by
+    // receiving a message, and counts itself before the message is uncounted, so once this
+    // reaches 0 no work is left anywhere and it stays 0.
+    atomic<long> work_count;
+    atomic<bool> done;
+    atomic<long> total_expanded; // expansions of all workers
+    atomic<int> stop_status; // SearchStatus of a limit that stopped the search, SEARCHING if none
+
+    mutex goal_mutex;
+    atomic<int> incumbent; // cost of the best plan found so far
+    int goal_worker = -1;
+    StateID goal_id = NO_STATE;
+    long first_goal_expansions = -1; // total_expanded when the first goal was expanded
+};
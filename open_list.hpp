@@ -0,0 +1,126 @@
+#include <vector>
+#include <limits>
+#include <tuple>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+// Open list for small non-negative integer priorities. Entries sit in buckets indexed by f
+// and then h, so push and pop are O(1) apart from moving the cursors past empty buckets,
+// which is amortized O(1) while the minimum f does not decrease (consistent heuristics).
+// Lower h breaks ties in f, and the most recent entry of a bucket comes first (LIFO).
+// The buckets are dense, so entries with f or h above MAX_PRIORITY (e.g. h^add times a large
+// weight) go to an overflow binary heap ordered the same way; both are merged on top and pop.
+class BucketOpenList
+{
+public:
+    static const int MAX_PRIORITY = 1 << 20;
+
+private:
+    vector<vector<vector<StateID>>> buckets; // f, h, state ids
+    vector<size_t> bucket_size; // f, number of entries
+    vector<int> min_h; // f, no entry has a lower h
+    int min_f = 0; // no entry has a lower f
+    size_t num_entries = 0; // in the buckets
+    vector<tuple<int, int, StateID>> overflow; // min-heap of (f, h, state id) beyond MAX_PRIORITY
+
+    // Move the cursors to the first bucket entry, the buckets must not be empty
+    vector<StateID>& first_bucket()
+    {
+        while (this->bucket_size[this->min_f] == 0)
+            this->min_f++;
+        vector<vector<StateID>>& by_h = this->buckets[this->min_f];
+        int& h = this->min_h[this->min_f];
+        while (by_h[h].empty())
+            h++;
+        return by_h[h];
+    }
+
+    // True if the first entry is in the overflow heap
+    bool overflow_first()
+    {
+        if (this->overflow.empty())
+            return false;
+        if (this->num_entries == 0)
+            return true;
+        first_bucket();
+        const tuple<int, int, StateID>& first = this->overflow.front();
+        return make_pair(get<0>(first), get<1>(first)) < make_pair(this->min_f, this->min_h[this->min_f]);
+    }
+
+public:
+    // Add an entry, f and h must not be negative
+    void push(int f, int h, StateID id)
+    {
+        if (f < 0 || h < 0)
+            throw invalid_argument("negative open list priority");
+        if (f > MAX_PRIORITY || h > MAX_PRIORITY)
+        {
+            this->overflow.emplace_back(f, h, id);
+            push_heap(this->overflow.begin(), this->overflow.end(), greater<tuple<int, int, StateID>>());
+            return;
+        }
+        if (f >= (int)this->buckets.size())
+        {
+            this->buckets.resize(f + 1);
+            this->bucket_size.resize(f + 1, 0);
+            this->min_h.resize(f + 1, numeric_limits<int>::max());
+        }
+        vector<vector<StateID>>& by_h = this->buckets[f];
+        if (h >= (int)by_h.size())
+            by_h.resize(h + 1);
+        by_h[h].push_back(id);
+
+        if (this->bucket_size[f]++ == 0 || h < this->min_h[f])
+            this->min_h[f] = h;
+        if (this->num_entries++ == 0 || f < this->min_f)
+            this->min_f = f;
+    }
+
+    // (f, state id) of the first entry
+    pair<int, StateID> top()
+    {
+        if (overflow_first())
+            return make_pair(get<0>(this->overflow.front()), get<2>(this->overflow.front()));
+        return make_pair(this->min_f, first_bucket().back());
+    }
+
+    void pop()
+    {
+        if (overflow_first())
+        {
+            pop_heap(this->overflow.begin(), this->overflow.end(), greater<tuple<int, int, StateID>>());
+            this->overflow.pop_back();
+            return;
+        }
+        first_bucket().pop_back();
+        this->bucket_size[this->min_f]--;
+        this->num_entries--;
+    }
+
+    bool empty() const
+    {
+        return this->num_entries == 0 && this->overflow.empty();
+    }
+
+    size_t size() const
+    {
+        return this->num_entries + this->overflow.size();
+    }
+
+    // Remove all entries, keeping the allocated buckets
+    void clear()
+    {
+        for (vector<vector<StateID>>& by_h : this->buckets)
+        {
+            for (vector<StateID>& bucket : by_h)
+                bucket.clear();
+        }
+        fill(this->bucket_size.begin(), this->bucket_size.end(), 0);
+        fill(this->min_h.begin(), this->min_h.end(), numeric_limits<int>::max());
+        this->min_f = 0;
+        this->num_entries = 0;
+        this->overflow.clear();
+    }
+};
@@ -0,0 +1,66 @@
+// Open list regression check: entries with priorities above BucketOpenList::MAX_PRIORITY must
+// come out of the list in (f, h) order together with the bucketed ones instead of being lost.
+//
+//     clang++ -std=c++17 -O2 -pthread open_list_check.cpp -o open_list_check.out
+//     ./open_list_check.out
+//
+// Random (f, h) pairs on both sides of the limit are pushed and popped, interleaved, and every
+// popped f is compared with a reference multiset.
+#define PLANNER_NO_MAIN
+#include "planner.cpp"
+
+#include <random>
+#include <cassert>
+
+int main()
+{
+    const int LIMIT = BucketOpenList::MAX_PRIORITY;
+    BucketOpenList open_list;
+    multiset<pair<int, int>> reference; // f, h
+    map<StateID, pair<int, int>> entries; // state id, (f, h)
+    mt19937 rng(1);
+    bool ok = true;
+
+    // a single entry beyond the limit
+    open_list.push(LIMIT + 5, LIMIT + 1, 7);
+    ok = ok && !open_list.empty() && open_list.top() == make_pair(LIMIT + 5, (StateID)7);
+    open_list.pop();
+    ok = ok && open_list.empty();
+
+    StateID next_id = 0;
+    long popped = 0;
+    for (int round = 0; round < 20000; round++)
+    {
+        if (reference.empty() || rng() % 3 != 0)
+        {
+            // about a quarter of the entries overflow, by f or by h
+            int h = rng() % 4 == 0 ? LIMIT + rng() % 1000 : rng() % 100;
+            int f = h + rng() % 100;
+            open_list.push(f, h, next_id);
+            entries[next_id] = make_pair(f, h);
+            reference.insert(make_pair(f, h));
+            next_id++;
+            continue;
+        }
+        pair<int, StateID> top = open_list.top();
+        open_list.pop();
+        pair<int, int> expected = *reference.begin();
+        ok = ok && top.first == expected.first && entries[top.second] == expected;
+        reference.erase(reference.begin());
+        popped++;
+    }
+    while (!reference.empty())
+    {
+        pair<int, StateID> top = open_list.top();
+        open_list.pop();
+        ok = ok && entries[top.second] == *reference.begin();
+        reference.erase(reference.begin());
+        popped++;
+    }
+    ok = ok && open_list.empty() && open_list.size() == 0;
+
+    cout << "Pushed: " << next_id << ", popped: " << popped << endl;
+    assert(ok);
+    cout << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}
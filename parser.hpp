@@ -0,0 +1,390 @@
+#include <string>
+#include <list>
+#include <deque>
+#include <vector>
+#include <string_view>
+#include <stdexcept>
+#include <unordered_set>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+// Syntax error in a problem file, with the position of the offending character
+class ParseError : public runtime_error
+{
+public:
+    int line;
+    int column;
+
+    ParseError(const string& filename, int line, int column, const string& message)
+        : runtime_error(filename + ":" + to_string(line) + ":" + to_string(column) + ": " + message)
+    {
+        this->line = line;
+        this->column = column;
+    }
+};
+
+// Read-only memory map of a whole file
+class MappedFile
+{
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+
+public:
+    // false if the file cannot be opened or mapped
+    bool open(const string& filename)
+    {
+        close();
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0;
+        if (ok && st.st_size > 0)
+        {
+            void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ok = map != MAP_FAILED;
+            if (ok)
+            {
+                this->data = (const char*)map;
+                this->length = st.st_size;
+            }
+        }
+        ::close(fd);
+        return ok;
+    }
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    void close()
+    {
+        if (this->data != nullptr)
+            munmap((void*)this->data, this->length);
+        this->data = nullptr;
+        this->length = 0;
+    }
+
+    size_t size() const
+    {
+        return this->length;
+    }
+
+    const char* begin() const
+    {
+        return this->data;
+    }
+
+    const char* end() const
+    {
+        return this->data + this->length;
+    }
+};
+
+// Single-pass parser of the problem format, reading the mapped file in place:
+//
+//     Symbols: A,B,Table
+//     Initial conditions: On(A,B), !Clear(B)
+//     Goal conditions: On(B,A)
+//     Actions:
+//         Move(b,x,y)
+//         Preconditions: On(b,x), Clear(b)
+//         Effects: On(b,y), !On(b,x)
+//
+// Each section is one line and headers are case-insensitive. As in the original format, spaces
+// are ignored everywhere, also inside names ("Initial conditions" is "initialconditions").
+// Predicates start with an upper-case letter, '!' negates a condition, and empty items between
+// commas are skipped. Errors throw ParseError with the line and column.
+// Names are string_views into the mapped file and atoms are interned into the env's AtomTable
+// straight from them; only the few names written with blanks inside are copied.
+class ProblemParser
+{
+private:
+    enum Section
+    {
+        SYMBOLS,
+        INITIAL,
+        GOAL,
+        ACTIONS,
+        ACTION_DEFINITION,
+        ACTION_PRECONDITION,
+        ACTION_EFFECT
+    };
+
+    string filename;
+    const char* p;
+    const char* end;
+    const char* line_start;
+    int line = 1;
+    Env* env;
+
+    deque<string> spaced_names; // names with blanks inside, joined; views point into them
+    vector<string_view> condition_args; // arguments of the condition being read
+
+    // action being read
+    string action_name;
+    list<string> action_args;
+    unordered_set<Condition, ConditionHasher, ConditionComparator> preconditions;
+    unordered_set<Condition, ConditionHasher, ConditionComparator> effects;
+
+    [[noreturn]] void error(const string& message)
+    {
+        throw ParseError(this->filename, this->line, this->p - this->line_start + 1, message);
+    }
+
+    static bool is_name_char(char c)
+    {
+        return isalnum((unsigned char)c) || c == '_';
+    }
+
+    void skip_blanks()
+    {
+        while (this->p < this->end && (*this->p == ' ' || *this->p == '\t' || *this->p == '\r'))
+            this->p++;
+    }
+
+    bool at_line_end()
+    {
+        return this->p == this->end || *this->p == '\n';
+    }
+
+    // Skip blanks and consume c if it is the next character
+    bool accept(char c)
+    {
+        skip_blanks();
+        if (this->p < this->end && *this->p == c)
+        {
+            this->p++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c)
+    {
+        if (!accept(c))
+            error(string("expected '") + c + "'");
+    }
+
+    // Name made of letters, digits and '_', ignoring blanks between its characters. The view
+    // lives as long as the parser.
+    string_view read_name(const char* what)
+    {
+        skip_blanks();
+        const char* start = this->p;
+        while (this->p < this->end && is_name_char(*this->p))
+            this->p++;
+        if (this->p == start)
+            error(string("expected ") + what);
+        const char* after = this->p;
+        skip_blanks();
+        if (this->p == this->end || !is_name_char(*this->p))
+        {
+            this->p = after;
+            return string_view(start, after - start);
+        }
+
+        // blanks inside the name: join its parts
+        string name(start, after);
+        while (this->p < this->end && is_name_char(*this->p))
+        {
+            name += *this->p++;
+            after = this->p;
+            skip_blanks();
+            if (this->p == this->end || !is_name_char(*this->p))
+                this->p = after;
+        }
+        this->spaced_names.push_back(move(name));
+        return this->spaced_names.back();
+    }
+
+    // Section header such as "Initial conditions:", compared case-insensitively without blanks.
+    // Returns false without consuming anything if the line starts with something else.
+    bool read_header(const char* header)
+    {
+        const char* start = this->p;
+        for (const char* h = header; *h; h++)
+        {
+            skip_blanks();
+            if (this->p == this->end || tolower((unsigned char)*this->p) != *h)
+            {
+                this->p = start;
+                return false;
+            }
+            this->p++;
+        }
+        if (!accept(':'))
+        {
+            this->p = start;
+            return false;
+        }
+        return true;
+    }
+
+    // "(a,b,c)"
+    void read_args(vector<string_view>& args)
+    {
+        args.clear();
+        expect('(');
+        do
+            args.push_back(read_name("an argument"));
+        while (accept(','));
+        expect(')');
+    }
+
+    // "[!]Predicate(args)"
+    void read_condition(string_view& predicate, vector<string_view>& args, bool& truth)
+    {
+        truth = !accept('!');
+        skip_blanks();
+        if (this->p == this->end || !isupper((unsigned char)*this->p))
+            error("expected a predicate starting with an upper-case letter");
+        predicate = read_name("a predicate");
+        read_args(args);
+    }
+
+    // Comma separated conditions up to the end of the line
+    template <typename F>
+    void read_conditions(F add)
+    {
+        string_view predicate;
+        bool truth;
+        while (true)
+        {
+            skip_blanks();
+            if (at_line_end())
+                return;
+            if (accept(','))
+                continue;
+            read_condition(predicate, this->condition_args, truth);
+            add(predicate, this->condition_args, truth);
+            skip_blanks();
+            if (!at_line_end() && *this->p != ',')
+                error("expected ',' between conditions");
+        }
+    }
+
+    void parse_line(Section& section)
+    {
+        switch (section)
+        {
+            case SYMBOLS:
+            {
+                if (!read_header("symbols"))
+                    error("expected 'Symbols:'");
+                do
+                    this->env->add_symbol(read_name("a symbol"));
+                while (accept(','));
+                section = INITIAL;
+                break;
+            }
+            case INITIAL:
+            case GOAL:
+            {
+                bool initial = section == INITIAL;
+                if (!read_header(initial ? "initialconditions" : "goalconditions"))
+                    error(initial ? "expected 'Initial conditions:'" : "expected 'Goal conditions:'");
+                read_conditions([&](string_view predicate, const vector<string_view>& args, bool truth)
+                {
+                    int atom_id = this->env->get_atoms().intern_atom(predicate, args);
+                    if (initial)
+                        this->env->set_initial_atom(atom_id, truth);
+                    else
+                        this->env->set_goal_atom(atom_id, truth);
+                });
+                section = initial ? GOAL : ACTIONS;
+                break;
+            }
+            case ACTIONS:
+                if (!read_header("actions"))
+                    error("expected 'Actions:'");
+                section = ACTION_DEFINITION;
+                break;
+            case ACTION_DEFINITION:
+                skip_blanks();
+                if (this->p == this->end || !isupper((unsigned char)*this->p))
+                    error("expected an action name starting with an upper-case letter");
+                this->action_name = string(read_name("an action name"));
+                read_args(this->condition_args);
+                this->action_args.assign(this->condition_args.begin(), this->condition_args.end());
+                section = ACTION_PRECONDITION;
+                break;
+            case ACTION_PRECONDITION:
+            case ACTION_EFFECT:
+            {
+                bool precondition = section == ACTION_PRECONDITION;
+                if (!read_header(precondition ? "preconditions" : "effects"))
+                    error(precondition ? "expected 'Preconditions:'" : "expected 'Effects:'");
+                auto& conditions = precondition ? this->preconditions : this->effects;
+                read_conditions([&](string_view predicate, const vector<string_view>& args, bool truth)
+                {
+                    conditions.insert(Condition(string(predicate), list<string>(args.begin(), args.end()), truth));
+                });
+                if (precondition)
+                {
+                    section = ACTION_EFFECT;
+                    break;
+                }
+                this->env->add_action(Action(this->action_name, this->action_args, this->preconditions, this->effects));
+                this->preconditions.clear();
+                this->effects.clear();
+                section = ACTION_DEFINITION;
+                break;
+            }
+        }
+
+        skip_blanks();
+        if (!at_line_end())
+            error("unexpected '" + string(1, *this->p) + "'");
+    }
+
+public:
+    ProblemParser(const string& filename, const char* begin, const char* end, Env* env)
+    {
+        this->filename = filename;
+        this->p = begin;
+        this->end = end;
+        this->line_start = begin;
+        this->env = env;
+    }
+
+    void parse()
+    {
+        Section section = SYMBOLS;
+        while (this->p < this->end)
+        {
+            skip_blanks();
+            if (!at_line_end())
+                parse_line(section);
+            if (this->p < this->end)
+                this->p++; // '\n'
+            this->line++;
+            this->line_start = this->p;
+        }
+
+        this->line--;
+        if (section < ACTIONS)
+            error(section == SYMBOLS ? "missing 'Symbols:'" : section == INITIAL ? "missing 'Initial conditions:'" : "missing 'Goal conditions:'");
+        if (section == ACTION_PRECONDITION || section == ACTION_EFFECT)
+            error("action " + this->action_name + " needs a 'Preconditions:' and an 'Effects:' line");
+    }
+
+    // One line of comma separated conditions, e.g. "On(A,B), !Clear(B)", without touching the env
+    list<GroundedCondition> parse_conditions()
+    {
+        list<GroundedCondition> conditions;
+        read_conditions([&](string_view predicate, const vector<string_view>& args, bool truth)
+        {
+            conditions.push_back(GroundedCondition(string(predicate), list<string>(args.begin(), args.end()), truth));
+        });
+        if (this->p < this->end)
+            error("expected a single line of conditions");
+        return conditions;
+    }
+};
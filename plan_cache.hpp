@@ -0,0 +1,330 @@
+#include <list>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <ostream>
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+// Map from 64-bit keys to values with least-recently-used eviction once the charged bytes of its
+// entries exceed max_bytes. Not thread-safe.
+template <typename V>
+class LruCache
+{
+private:
+    struct Entry
+    {
+        uint64_t key;
+        V value;
+        size_t bytes;
+    };
+
+    list<Entry> entries; // most recently used first
+    unordered_map<uint64_t, typename list<Entry>::iterator> index;
+    size_t max_bytes;
+    size_t used_bytes = 0;
+
+public:
+    // list node, hash node and bucket of one entry, charged on top of its value
+    static const size_t ENTRY_OVERHEAD = 80;
+
+    long evictions = 0;
+
+    LruCache(size_t max_bytes)
+    {
+        this->max_bytes = max_bytes;
+    }
+
+    // Value of key (now the most recently used), nullptr if absent
+    const V* find(uint64_t key)
+    {
+        auto it = this->index.find(key);
+        if (it == this->index.end())
+            return nullptr;
+        this->entries.splice(this->entries.begin(), this->entries, it->second);
+        return &it->second->value;
+    }
+
+    // Insert or replace the value of key, charged bytes plus ENTRY_OVERHEAD
+    void insert(uint64_t key, V value, size_t bytes = sizeof(V))
+    {
+        bytes += ENTRY_OVERHEAD;
+        if (bytes > this->max_bytes)
+            return;
+        auto it = this->index.find(key);
+        if (it != this->index.end())
+        {
+            this->used_bytes -= it->second->bytes;
+            this->entries.erase(it->second);
+            this->index.erase(it);
+        }
+        this->entries.push_front(Entry{ key, move(value), bytes });
+        this->index[key] = this->entries.begin();
+        this->used_bytes += bytes;
+        while (this->used_bytes > this->max_bytes)
+        {
+            this->used_bytes -= this->entries.back().bytes;
+            this->index.erase(this->entries.back().key);
+            this->entries.pop_back();
+            this->evictions++;
+        }
+    }
+
+    size_t size() const
+    {
+        return this->entries.size();
+    }
+
+    size_t bytes() const
+    {
+        return this->used_bytes;
+    }
+};
+
+// Fixed-size table from (state, goal, kind) to an int, for the goal distances and h values of
+// PlanCache. The slots and the state bits they hold are allocated once, so lookups and stores never
+// allocate. Each key hashes to a set of WAYS slots; a full set replaces its slots round-robin. A slot
+// keeps the whole state, so a Zobrist hash collision is a miss and never another state's value.
+// The sets are split between NUM_STRIPES mutexes, and concurrent searches only wait for each other
+// on the same stripe.
+class StateValueTable
+{
+private:
+    static const int WAYS = 4;
+    static const int NUM_STRIPES = 64;
+    static const int EMPTY = numeric_limits<int>::min(); // kind of an unused slot
+
+    struct Slot
+    {
+        uint64_t key = 0;
+        int value = 0;
+        int kind = EMPTY;
+    };
+
+    int num_words;
+    size_t num_sets;
+    vector<Slot> slots; // set * WAYS + way
+    vector<uint64_t> states; // slot * num_words, the state words of each slot
+    vector<uint8_t> next_victim; // set, way replaced when the set is full
+    mutex stripes[NUM_STRIPES];
+
+    bool same_state(size_t slot, const State& state) const
+    {
+        return equal(state.get_words().begin(), state.get_words().end(), this->states.begin() + slot * this->num_words);
+    }
+
+public:
+    atomic<long> evictions{ 0 };
+
+    // At most max_bytes for states of num_atoms atoms
+    StateValueTable(size_t max_bytes, int num_atoms)
+    {
+        this->num_words = (num_atoms + 63) / 64;
+        size_t slot_bytes = sizeof(Slot) + this->num_words * sizeof(uint64_t);
+        this->num_sets = max<size_t>(1, max_bytes / (slot_bytes * WAYS));
+        this->slots.resize(this->num_sets * WAYS);
+        this->states.resize(this->slots.size() * this->num_words);
+        this->next_victim.resize(this->num_sets, 0);
+    }
+
+    // Value stored for (state, kind) under key, false if absent
+    bool find(uint64_t key, const State& state, int kind, int& value)
+    {
+        size_t set = key % this->num_sets;
+        lock_guard<mutex> lock(this->stripes[set % NUM_STRIPES]);
+        for (size_t slot = set * WAYS; slot < (set + 1) * WAYS; slot++)
+        {
+            const Slot& s = this->slots[slot];
+            if (s.kind == kind && s.key == key && same_state(slot, state))
+            {
+                value = s.value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Insert or replace the value of (state, kind) under key
+    void insert(uint64_t key, const State& state, int kind, int value)
+    {
+        size_t set = key % this->num_sets;
+        lock_guard<mutex> lock(this->stripes[set % NUM_STRIPES]);
+        size_t target = set * WAYS + this->next_victim[set];
+        bool found = false;
+        for (size_t slot = set * WAYS; slot < (set + 1) * WAYS && !found; slot++)
+        {
+            const Slot& s = this->slots[slot];
+            if (s.kind == kind && s.key == key && same_state(slot, state))
+            {
+                target = slot;
+                found = true;
+            }
+            else if (s.kind == EMPTY)
+                target = slot;
+        }
+        Slot& s = this->slots[target];
+        if (!found && s.kind != EMPTY)
+        {
+            this->evictions++;
+            this->next_victim[set] = (this->next_victim[set] + 1) % WAYS;
+        }
+        s.key = key;
+        s.kind = kind;
+        s.value = value;
+        copy(state.get_words().begin(), state.get_words().end(), this->states.begin() + target * this->num_words);
+    }
+
+    // Number of used slots, and of those of one kind, counted by locking every stripe
+    size_t count(int kind, size_t& used)
+    {
+        size_t n = 0;
+        used = 0;
+        for (size_t set = 0; set < this->num_sets; set++)
+        {
+            lock_guard<mutex> lock(this->stripes[set % NUM_STRIPES]);
+            for (size_t slot = set * WAYS; slot < (set + 1) * WAYS; slot++)
+            {
+                used += this->slots[slot].kind != EMPTY;
+                n += this->slots[slot].kind == kind;
+            }
+        }
+        return n;
+    }
+
+    size_t bytes() const
+    {
+        return this->slots.size() * sizeof(Slot) + this->states.size() * sizeof(uint64_t) + this->next_victim.size();
+    }
+};
+
+// Results of earlier searches on one grounded task, shared by concurrent planners:
+//   plans:     (initial state, goal, search configuration) -> action indices of the plan found
+//   distances: (state, goal) -> exact goal distance, for the states along optimal plans
+//   h values:  (state, goal, heuristic) -> heuristic value computed by an earlier search
+// Goals are keyed by goal_key. Plans are keyed by the Zobrist hash of their initial state, so a key
+// collision is possible in principle; cached plans are therefore replayed before they are returned
+// (see BatchPlanner). Distances and h values are looked up on every heuristic call, so they live in
+// a preallocated lock-striped StateValueTable that compares whole states. They seed the heuristic
+// of later searches. Searches that must return optimal plans only take cached h values: A* does not
+// reopen nodes, and mixing exact distances with a consistent heuristic would make it inconsistent.
+// The byte budget is split a quarter for the plans and the rest for the state values, which are
+// allocated up front.
+class PlanCache
+{
+private:
+    // StateValueTable kind of the distances, the h values use the heuristic number
+    static const int DISTANCE = -2;
+
+    mutex cache_mutex; // guards plans
+    LruCache<vector<int>> plans;
+    StateValueTable state_values;
+
+    static uint64_t mix(uint64_t x)
+    {
+        // splitmix64 finalizer
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+public:
+    static uint64_t combine(uint64_t a, uint64_t b)
+    {
+        return mix(a ^ mix(b + 0x9e3779b97f4a7c15ULL));
+    }
+
+    atomic<long> plan_hits{ 0 };
+    atomic<long> plan_misses{ 0 };
+    atomic<long> distance_hits{ 0 };
+    atomic<long> h_hits{ 0 };
+    atomic<long> h_misses{ 0 }; // neither a distance nor an h value was cached
+
+    // A cache of at most max_bytes for a task with num_atoms atoms
+    PlanCache(size_t max_bytes, int num_atoms)
+        : plans(max_bytes / 4), state_values(max_bytes - max_bytes / 4, num_atoms)
+    {
+    }
+
+    // Key of a set of goal atoms (sorted and without duplicates)
+    static uint64_t goal_key(const vector<int>& goal_atoms)
+    {
+        uint64_t key = goal_atoms.size();
+        for (int atom_id : goal_atoms)
+            key = combine(key, atom_id);
+        return key;
+    }
+
+    // config identifies the search settings that produced the plan (engine, heuristic, weight...)
+    static uint64_t plan_key(uint64_t state_hash, uint64_t goal_key, uint64_t config)
+    {
+        return combine(combine(state_hash, goal_key), config);
+    }
+
+    bool find_plan(uint64_t key, vector<int>& actions)
+    {
+        lock_guard<mutex> lock(this->cache_mutex);
+        const vector<int>* plan = this->plans.find(key);
+        if (plan == nullptr)
+            return false;
+        actions = *plan;
+        return true;
+    }
+
+    void store_plan(uint64_t key, const vector<int>& actions)
+    {
+        lock_guard<mutex> lock(this->cache_mutex);
+        this->plans.insert(key, actions, sizeof(actions) + actions.size() * sizeof(int));
+    }
+
+    // Heuristic seed of a state with Zobrist hash state_hash: its exact goal distance if known and
+    // use_distances is set, else a cached h value
+    bool find_h(const State& state, uint64_t state_hash, uint64_t goal_key, int heuristic, bool use_distances, int& h)
+    {
+        uint64_t state_goal = combine(state_hash, goal_key);
+        if (use_distances && this->state_values.find(combine(state_goal, DISTANCE), state, DISTANCE, h))
+        {
+            this->distance_hits++;
+            return true;
+        }
+        if (!this->state_values.find(combine(state_goal, heuristic), state, heuristic, h))
+        {
+            this->h_misses++;
+            return false;
+        }
+        this->h_hits++;
+        return true;
+    }
+
+    // Goal distances of the states visited by an optimal plan: states[i] is the state after i
+    // actions and state_hashes[i] its Zobrist hash, the last one satisfies the goal
+    void store_distances(const vector<State>& states, const vector<uint64_t>& state_hashes, uint64_t goal_key)
+    {
+        int n = states.size();
+        for (int i = 0; i < n; i++)
+            this->state_values.insert(combine(combine(state_hashes[i], goal_key), DISTANCE), states[i], DISTANCE, n - 1 - i);
+    }
+
+    // Value of heuristic computed for a state with Zobrist hash state_hash
+    void store_h(const State& state, uint64_t state_hash, uint64_t goal_key, int heuristic, int h)
+    {
+        this->state_values.insert(combine(combine(state_hash, goal_key), heuristic), state, heuristic, h);
+    }
+
+    // One JSON object with the counters and sizes
+    void dump(ostream& out)
+    {
+        size_t used;
+        size_t distances = this->state_values.count(DISTANCE, used);
+        size_t h_values = used - distances;
+        lock_guard<mutex> lock(this->cache_mutex);
+        out << "{\"plan_hits\": " << this->plan_hits.load() << ", \"plan_misses\": " << this->plan_misses.load()
+            << ", \"distance_hits\": " << this->distance_hits.load() << ", \"h_hits\": " << this->h_hits.load()
+            << ", \"h_misses\": " << this->h_misses.load() << ", \"plans\": " << this->plans.size()
+            << ", \"distances\": " << distances << ", \"h_values\": " << h_values
+            << ", \"bytes\": " << this->plans.bytes() + this->state_values.bytes()
+            << ", \"evictions\": " << this->plans.evictions + this->state_values.evictions.load() << "}";
+    }
+};
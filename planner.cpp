@@ -1,72 +1,122 @@
 #include "planner.hpp"
+#include "batch_planner.hpp"
 
 using namespace std;
 
 bool print_status = true;
 bool debug = false;
-int which_heuristic = 1;
+SearchOptions search_options; // heuristic, engine and limits used by planner()
 
-// backrack from goal to start
+// Names of SymbolicPlanner::heuristic values and SearchEngine values on the command line
+const vector<string> heuristic_names = { "zero", "goalcount", "edl", "hmax", "hadd", "ff" };
+const vector<string> engine_names = { "astar", "gbfs", "rwastar", "hdastar" };
+
+// Heuristic number of a name in heuristic_names (or the number itself)
+int parse_heuristic(const string& name)
+{
+    for (size_t i = 0; i < heuristic_names.size(); i++)
+    {
+        if (name == heuristic_names[i] || name == to_string(i))
+            return i;
+    }
+    throw invalid_argument("unknown heuristic " + name);
+}
+
+SearchEngine parse_engine(const string& name)
+{
+    for (size_t i = 0; i < engine_names.size(); i++)
+    {
+        if (name == engine_names[i])
+            return (SearchEngine)i;
+    }
+    throw invalid_argument("unknown engine " + name);
+}
+
+// Name of a SearchStatus in reports
+const char* status_name(SearchStatus status)
+{
+    switch (status)
+    {
+        case SEARCHING:
+            return "SEARCHING";
+        case SOLVED:
+            return "SOLVED";
+        case UNSOLVABLE:
+            return "UNSOLVABLE";
+        case NODE_LIMIT:
+            return "NODE_LIMIT";
+        case TIME_LIMIT:
+            return "TIME_LIMIT";
+        case MEMORY_LIMIT:
+            return "MEMORY_LIMIT";
+        case OUT_OF_TASK:
+            return "OUT_OF_TASK";
+        case ERROR:
+            return "ERROR";
+    }
+    return "UNKNOWN";
+}
+
+// backrack from the cheapest goal state found to start (empty plan if none was found)
 list<GroundedAction> SymbolicPlanner::backtrack()
+{
+    PhaseTimer timer(stats.backtrack_time);
+    StateID best_goal = NO_STATE;
+    for (StateID goal_id : goal_ids)
+    {
+        if (best_goal == NO_STATE || node_info[goal_id].g < node_info[best_goal].g)
+            best_goal = goal_id;
+    }
+    if (best_goal == NO_STATE)
+    {
+        plan_actions.clear();
+        return list<GroundedAction>();
+    }
+    return backtrack(best_goal);
+}
+
+// backrack from a reached state to start, one parent record per step
+list<GroundedAction> SymbolicPlanner::backtrack(StateID goal_id)
 {
     list<GroundedAction> plan;
-    auto goal_state = this->env->get_goal_conditions();
-    string goal_str = condition_to_string(goal_state);
-    auto start_state = this->env->get_initial_conditions();
-    string start_str = condition_to_string(start_state);
-
-    string current_state = goal_str;
-    while (current_state != start_str)
-    {
-        int action_index = node_info[current_state].parent;
-        vector<GroundedAction> all_gacs = this->get_grounded_actions();
-        GroundedAction action = all_gacs.at(action_index);
-        plan.push_front(action);
-        current_state = node_info[current_state].parent_node_str;
+    plan_actions.clear();
+    StateID current_state = goal_id;
+    while (current_state != start_id)
+    {
+        const ParentRecord& parent = parents[current_state];
+        plan.push_front(this->task->actions[parent.action]);
+        plan_actions.push_back(parent.action);
+        current_state = parent.parent_id;
     }
+    reverse(plan_actions.begin(), plan_actions.end());
     return plan;
 }
 
-// Compute all possible grounded actions from a state
+// Compute all grounded actions reachable from the initial state
 void SymbolicPlanner::compute_all_grounded_actions()
 {
+    PhaseTimer timer(stats.grounding_time);
     // All actions (ungrounded)
-    auto actions = this->env->get_actions();
-
-    // All symbols as unordered_set of strings
-    auto symbols = this->env->get_symbols();
+    const auto& actions_set = this->env->get_actions();
+    vector<Action> actions(actions_set.begin(), actions_set.end());
 
-    // Convert symbols to vector of strings
-    vector<string> symbols_vec;
-    for (string s : symbols)
-        symbols_vec.push_back(s);
+    // Argument bindings of all actions reachable from the initial state
+    Grounder grounder(this->env, actions);
+    vector<vector<vector<int>>> bindings = grounder.ground();
+    this->task->static_blockers = grounder.get_static_blockers();
+    const AtomTable& atoms = this->env->get_atoms();
 
-    int num_args = 0;
-
-    vector<vector<string>> symbol_combinations;
-    vector<vector<string>> symbol_permutations;
-    
-    // For each action (ungrounded), compute all possible grounded actions
-    for (Action a : actions)
+    // For each action (ungrounded), build its reachable grounded actions
+    for (size_t action_index = 0; action_index < actions.size(); action_index++)
     {
-        // Find number of arguments for action a
-        num_args = a.get_args().size();
+        const Action& a = actions[action_index];
 
-        // Find all combinations of symbols for each action
-        symbol_combinations = combinations(symbols_vec, num_args);
-
-        // Find all possible permutations of symbols for the arguments
-        for(int i=0; i<symbol_combinations.size(); i++)
-        {
-            permute(symbol_combinations[i], symbol_permutations, 0, num_args - 1);
-        }
-        
-        // Get all possible grounded actions for symbol permutations and add to list of grounded actions
-        for (vector<string> symbol_permutation : symbol_permutations)
+        for (const vector<int>& binding : bindings[action_index])
         {
-            list<string> args = a.get_args();
+            const list<string>& args = a.get_args();
             list<string> grounded_args;
-            copy(symbol_permutation.begin(), symbol_permutation.end(), back_inserter(grounded_args));
+            for (int symbol_id : binding)
+                grounded_args.push_back(atoms.symbol_name(symbol_id));
 
             // build map from action arguments to grounded action arguments
             unordered_map<string, string> arg_map;
@@ -83,10 +133,10 @@ void SymbolicPlanner::compute_all_grounded_actions()
             unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> grounded_effects;
 
             // make grounded preconditions using action preconditions and arg_map
-            for (Condition precon : a.get_preconditions())
+            for (const Condition& precon : a.get_preconditions())
             {
                 list<string> grounded_precon_args;
-                for (string arg : precon.get_args())
+                for (const string& arg : precon.get_args())
                 {
                     if(arg_map[arg] == "")
                         grounded_precon_args.push_back(arg);
@@ -94,14 +144,15 @@ void SymbolicPlanner::compute_all_grounded_actions()
                         grounded_precon_args.push_back(arg_map[arg]);
                 }
                 GroundedCondition grounded_precon(precon.get_predicate(), grounded_precon_args, precon.get_truth());
+                this->env->intern_condition(grounded_precon);
                 grounded_precons.insert(grounded_precon);
             }
 
             // make grounded effects using action effects and arg_map
-            for (Condition effect : a.get_effects())
+            for (const Condition& effect : a.get_effects())
             {
                 list<string> grounded_effect_args;
-                for (string arg : effect.get_args())
+                for (const string& arg : effect.get_args())
                 {
                     if(arg_map[arg] == "")
                         grounded_effect_args.push_back(arg);
@@ -109,25 +160,92 @@ void SymbolicPlanner::compute_all_grounded_actions()
                         grounded_effect_args.push_back(arg_map[arg]);
                 }
                 GroundedCondition grounded_effect(effect.get_predicate(), grounded_effect_args, effect.get_truth());
+                this->env->intern_condition(grounded_effect);
                 grounded_effects.insert(grounded_effect);
             }
 
             GroundedAction ga(a.get_name(), grounded_args, grounded_precons, grounded_effects);
-            this->grounded_actions.push_back(ga);
+            this->task->actions.push_back(ga);
         }
+    }
+    this->task->build(this->env->get_atoms().num_atoms());
+    init_search_context();
+}
+
+// Use already grounded actions (e.g. from the task cache), whose atoms must all be in the env
+void SymbolicPlanner::set_grounded_actions(vector<GroundedAction> actions, vector<int> static_blockers)
+{
+    PhaseTimer timer(stats.grounding_time);
+    this->task->actions = move(actions);
+    this->task->static_blockers = move(static_blockers);
+    this->task->build(this->env->get_atoms().num_atoms());
+    init_search_context();
+}
 
-        // Clear symbol combinations and permutations for next action
-        symbol_combinations.clear();
-        symbol_permutations.clear();
+// Build the goal mask, state registry and heuristics of this planner over the built task
+void SymbolicPlanner::init_search_context()
+{
+    this->goal_mask = State(this->task->num_atoms, this->goal_atoms);
+    this->state_registry = StateRegistry(this->task->zobrist, this->task->num_atoms);
+    this->relaxed_heuristic = this->task->relaxed_heuristic;
+    this->relaxed_heuristic.set_goal(this->goal_atoms);
+    if (this->options.eval_threads > 1)
+    {
+        this->eval_pool.reset(new ThreadPool(this->options.eval_threads));
+        this->eval_heuristics.assign(this->options.eval_threads, this->relaxed_heuristic);
     }
 }
 
+// Plan another initial state and goal of the task with this planner. The search context (state
+// registry, nodes, parents and open list) keeps its storage, the next search clears it in O(1).
+void SymbolicPlanner::set_query(const vector<int> &initial_atoms, const vector<int> &goal_atoms, const SearchOptions &options)
+{
+    this->initial_atoms = initial_atoms;
+    this->goal_atoms = goal_atoms;
+    this->options = options;
+    this->start_time = wall_clock_seconds();
+    this->goal_mask = State(this->task->num_atoms, goal_atoms);
+    this->relaxed_heuristic.set_goal(goal_atoms);
+    for (RelaxedHeuristic& relaxed : this->eval_heuristics)
+        relaxed.set_goal(goal_atoms);
+
+    status = SEARCHING;
+    start_id = NO_STATE;
+    goal_ids.clear();
+    first_goal_expansions = -1;
+    num_expanded = 0;
+    num_generated = 0;
+    stats.clear();
+    cost_bound = numeric_limits<int>::max();
+    best_plan.clear();
+    plan_proven_optimal = false;
+    plan_actions.clear();
+    plan_cache = nullptr;
+    goal_key = 0;
+}
+
 // Calculate heuristic value for a given node
-int SymbolicPlanner::heuristic(unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> &state)
+int SymbolicPlanner::heuristic(const State &state)
 {
+    return heuristic(state, this->relaxed_heuristic);
+}
+
+// Same, with the scratch buffers of relaxed so that search threads can evaluate in parallel
+int SymbolicPlanner::heuristic(const State &state, RelaxedHeuristic &relaxed)
+{
+    // goal distances and values of earlier searches, for the heuristics that are worth a lookup
+    bool use_cache = this->plan_cache != nullptr && this->options.heuristic >= 2;
+    uint64_t state_hash = use_cache ? this->task->zobrist.hash_state(state) : 0;
+    if (use_cache)
+    {
+        int cached;
+        if (this->plan_cache->find_h(state, state_hash, this->goal_key, this->options.heuristic, !this->options.optimal(), cached))
+            return cached;
+    }
+
+    double start = STATS_ENABLED ? wall_clock_seconds() : 0;
     int heauristic_value = 0;
-    auto goal = this->env->get_goal_conditions();
-    switch (which_heuristic)
+    switch (this->options.heuristic)
     {
         // h(s) = 0
         case 0:
@@ -143,264 +261,754 @@ int SymbolicPlanner::heuristic(unordered_set<GroundedCondition, GroundedConditio
         case 2:
             heauristic_value = empty_delete_list_heur(state);
             break;
+
+        // h(s) = h^max
+        case 3:
+            heauristic_value = hmax_heur(state, relaxed);
+            break;
+
+        // h(s) = h^add
+        case 4:
+            heauristic_value = hadd_heur(state, relaxed);
+            break;
+
+        // h(s) = h^FF
+        case 5:
+            heauristic_value = ff_heur(state, relaxed);
+            break;
     }
-    
+
+    stats.count(stats.heuristic_calls);
+    if (STATS_ENABLED)
+        stats.count(stats.heuristic_ns, (wall_clock_seconds() - start) * 1e9);
+    if (use_cache)
+        this->plan_cache->store_h(state, state_hash, this->goal_key, this->options.heuristic, heauristic_value);
     return heauristic_value;
 }
 
 // h(s) = No of unsatisfied literals
-int SymbolicPlanner::simple_heur(unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> &state)
+int SymbolicPlanner::simple_heur(const State &state)
 {
-    int heauristic_value = 0;
-    auto goal = this->env->get_goal_conditions();
-    for(GroundedCondition condition : goal)
-    {
-        if(state.find(condition) == state.end())
-            heauristic_value++;
-    }
-    return heauristic_value;
+    return state.count_missing(this->goal_mask);
 }
 
-// Compute empty-delete-list heuristic
-int SymbolicPlanner::empty_delete_list_heur(unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> &state)
+// h(s) = cost of the most expensive goal atom in the delete relaxation
+int SymbolicPlanner::hmax_heur(const State &state, RelaxedHeuristic &relaxed)
 {
-    unordered_set<string> closed_list_; // idx of expanded nodes
-    unordered_map<string, node> node_info_; // idx, node
-    unordered_map<string, int> state_map_; // string_state, idx
-    // f value, string state: sorted according to f value
-    priority_queue<pair<int, string>, vector<pair<int, string>>, greater<pair<int, string>>> open_list_;
+    return relaxed.compute(state, RelaxedHeuristic::HMAX);
+}
+
+// h(s) = sum of the goal atom costs in the delete relaxation
+int SymbolicPlanner::hadd_heur(const State &state, RelaxedHeuristic &relaxed)
+{
+    return relaxed.compute(state, RelaxedHeuristic::HADD);
+}
 
-    int num_actions = 0;
+// h(s) = size of the FF relaxed plan
+int SymbolicPlanner::ff_heur(const State &state, RelaxedHeuristic &relaxed)
+{
+    return relaxed.compute(state, RelaxedHeuristic::HFF);
+}
+
+// Compute empty-delete-list heuristic
+int SymbolicPlanner::empty_delete_list_heur(const State &state)
+{
+    StateRegistry state_registry_(this->task->zobrist, this->task->num_atoms); // unique states, state id
+    RecordPool<node> node_info_; // state id, node
+    // f value, state id: sorted according to f value
+    BucketOpenList open_list_;
 
     // Add start state to open list
-    string start_state_str = condition_to_string(state);
-    node_info_[start_state_str].state = state;
-    node_info_[start_state_str].g = 0;
-    node_info_[start_state_str].h = simple_heur(state);
-    int f = 0 + node_info_[start_state_str].h;
-    open_list_.push(make_pair(f, start_state_str));
-
-    auto goal_state = this->env->get_goal_conditions();
-    string goal_str = condition_to_string(goal_state);
+    StateID start_state_id = state_registry_.insert_state(state).first;
+    node_info_.resize(state_registry_.size());
+    node_info_[start_state_id].g = 0;
+    node_info_[start_state_id].h = simple_heur(state);
+    int f = 0 + node_info_[start_state_id].h;
+    open_list_.push(f, node_info_[start_state_id].h, start_state_id);
+
+    State current_state(this->task->num_atoms);
+    vector<int> applicable; // indices of actions applicable in current_state
     while(!open_list_.empty())
     {
-        // cout<<"Open list size: "<<open_list_.size()<<endl;
-        // cout<<"Closed list size: "<<closed_list_.size()<<endl;
-        pair<int, string> current_node_idx = open_list_.top();   //f-value, cell state
+        pair<int, StateID> current_node_idx = open_list_.top();   //f-value, state id
         open_list_.pop();
-        string current_node_str = current_node_idx.second;
-        if(in_closed_list(closed_list_, current_node_str))
+        StateID current_id = current_node_idx.second;
+        if(node_info_[current_id].closed)
             continue;
-        closed_list_.insert(current_node_str);
+        node_info_[current_id].closed = true;
 
-        node current_node = node_info_[current_node_str];
+        int current_g = node_info_[current_id].g;
+        state_registry_.get_state(current_id, current_state);
+        uint64_t current_hash = state_registry_.get_hash(current_id);
 
-        int action_count = -1;
+        applicable.clear();
+        this->task->successor_generator.generate_applicable_actions(current_state, applicable);
 
-        for(GroundedAction ga : this->grounded_actions)
+        for(int action_count : applicable)
         {
-            ++action_count;
-            if(this->is_action_valid(current_node.state, ga))
-            {
-                node next_node = this->take_action_relaxed(current_node, ga);
-                string next_node_str = condition_to_string(next_node.state);
+            GroundedAction& ga = this->task->actions[action_count];
+            State next_state = this->take_action_relaxed(current_state, ga);
+            uint64_t next_hash = ga.relaxed_successor_hash(current_hash, current_state, this->task->zobrist);
+            pair<StateID, bool> inserted = state_registry_.insert_state(next_state, next_hash);
+            StateID next_id = inserted.first;
+            if(inserted.second)
+                node_info_.resize(state_registry_.size());
 
-                if(in_closed_list(closed_list_, next_node_str))
-                    continue;
+            if(node_info_[next_id].closed)
+                continue;
 
-                // check if new node g-value is greater than current g-value + cost
-                if(node_info_[next_node_str].g > current_node.g + 1)
-                {
-                    // break if goal reached
-                    if(goal_reached(next_node.state))
-                    {
-                        node_info_[goal_str].g = current_node.g + 1;
-                        node_info_[goal_str].parent = action_count;
-                        node_info_[goal_str].state = next_node.state;
-                        node_info_[goal_str].parent_node_str = current_node_str;
-
-                        string ittr = goal_str;
-                        while(ittr != start_state_str)
-                        {
-                            num_actions++;
-                            ittr = node_info_[ittr].parent_node_str;
-                        }
-                        return num_actions;
-                    }
-                    node_info_[next_node_str].g = current_node.g + 1;
-                    node_info_[next_node_str].h = simple_heur(next_node.state);
-                    node_info_[next_node_str].parent = action_count;
-                    node_info_[next_node_str].state = next_node.state;
-                    node_info_[next_node_str].parent_node_str = current_node_str;
-                    // cout<<node_info_[next_node_str].h<<endl;
-                    int f = node_info_[next_node_str].g + node_info_[next_node_str].h;
-                    open_list_.push(make_pair(f, next_node_str));
-                }
+            // check if new node g-value is greater than current g-value + cost
+            if(node_info_[next_id].g > current_g + 1)
+            {
+                // return length of the relaxed plan if goal reached
+                if(goal_reached(next_state))
+                    return current_g + 1;
+
+                node_info_[next_id].g = current_g + 1;
+                node_info_[next_id].h = simple_heur(next_state);
+                int f = node_info_[next_id].g + node_info_[next_id].h;
+                open_list_.push(f, node_info_[next_id].h, next_id);
             }
         }
     }
-    return num_actions;
+    return 0;
 }
 
 
-// Initialize start node for A* search
+// Initialize start node for A* search, discarding any previous search
 void SymbolicPlanner::init_start_node()
 {
     // Get initial state
-    auto init_state = this->env->get_initial_conditions();
-    string initial_state = condition_to_string(init_state);
-    node_info[initial_state].state = init_state;
-    node_info[initial_state].g = 0;
-    node_info[initial_state].h = heuristic(node_info[initial_state].state);
-    int f = node_info[initial_state].g + node_info[initial_state].h;
-    open_list.push(make_pair(f, initial_state));
+    State init_state(this->task->num_atoms, this->initial_atoms);
+    // the states and nodes of a previous search are dropped in O(1), their storage is reused
+    state_registry.clear();
+    node_info.clear();
+    parents.clear();
+    open_list.clear();
+    goal_ids.clear();
+    first_goal_expansions = -1;
+    start_id = state_registry.insert_state(init_state).first;
+    node_info.resize(state_registry.size());
+    parents.resize(state_registry.size());
+    node_info[start_id].g = 0;
+    node_info[start_id].h = heuristic(init_state);
+    node_info[start_id].evaluated = true;
+    open_node(start_id);
 }
 
-bool SymbolicPlanner::in_closed_list(unordered_set<string> &closed_list, string &idx)
+// Start a new RWA* iteration from the initial state. The registered states and their heuristic
+// values are kept, so states seen by earlier iterations are not evaluated again; g values and
+// closed flags are reset. Parents are overwritten when a node gets its first g of the iteration.
+void SymbolicPlanner::restart_search()
 {
-    if (closed_list.find(idx) == closed_list.end())
-        return false;
-    else
-        return true;
+    for (size_t id = 0; id < node_info.size(); id++)
+    {
+        node_info[id].g = numeric_limits<int>::max();
+        node_info[id].closed = false;
+    }
+    open_list.clear();
+    goal_ids.clear();
+    first_goal_expansions = -1;
+    node_info[start_id].g = 0;
+    open_node(start_id);
+}
+
+// Queue a node for expansion, unless its goal is unreachable even in the relaxation (then a
+// search from a dead-end start ends with an empty open list)
+void SymbolicPlanner::open_node(StateID id)
+{
+    const node& n = node_info[id];
+    if (n.h == DEAD_END)
+        return;
+    open_list.push(f_value(n.g, n.h), n.h, id);
+}
+
+// Priority of a node in the open list, never negative for a validated weight
+int SymbolicPlanner::f_value(int g, int h)
+{
+    assert(g >= 0 && h >= 0 && options.weight >= 1);
+    if (options.engine == GBFS)
+        return h;
+    return g + options.weight * h;
 }
 
 // Check if action can be taken in given state
-bool SymbolicPlanner::is_action_valid(unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> &state, GroundedAction &a)
+bool SymbolicPlanner::is_action_valid(const State &state, const GroundedAction &a)
 {
-    // Check if all preconditions are satisfied
-    for (GroundedCondition precon : a.get_preconditions())
+    // Check if all preconditions are satisfied: (state & pre) == pre and no negative precondition holds
+    return state.contains(a.get_precondition_mask()) && !state.intersects(a.get_negative_precondition_mask());
+}
+
+// Take action in given state
+State SymbolicPlanner::take_action(const State &state, const GroundedAction &a)
+{
+    State new_state = state;
+
+    // (state & ~del) | add
+    new_state.apply(a.get_add_mask(), a.get_delete_mask());
+
+    return new_state;
+}
+
+// Take relaxed action in given state
+State SymbolicPlanner::take_action_relaxed(const State &state, const GroundedAction &a)
+{
+    State new_state = state;
+
+    // Add effects of action to new state
+    new_state.apply_relaxed(a.get_add_mask());
+
+    return new_state;
+}
+
+// Check if goal reached
+bool SymbolicPlanner::goal_reached(const State &state)
+{
+    return state.contains(this->goal_mask);
+}
+
+// Record a reached goal state; true (and status SOLVED) once options.goal_limit goals were found
+bool SymbolicPlanner::record_goal(StateID goal_id)
+{
+    if (find(goal_ids.begin(), goal_ids.end(), goal_id) == goal_ids.end())
     {
-        if (state.find(precon) == state.end())
-            return false;
+        if (goal_ids.empty())
+            first_goal_expansions = num_expanded;
+        goal_ids.push_back(goal_id);
     }
+    if ((int)goal_ids.size() < options.goal_limit)
+        return false;
+    status = SOLVED;
     return true;
 }
 
-// Take action in given state
-SymbolicPlanner::node SymbolicPlanner::take_action(node &n, GroundedAction &a)
+// Check node, time and memory limits, setting status if one is exceeded
+bool SymbolicPlanner::limits_exceeded()
 {
-    node new_node;
-    new_node.state = n.state;
+    if (options.node_limit >= 0 && num_expanded >= options.node_limit)
+        status = NODE_LIMIT;
+    // the steady clock is cheap next to an expansion, getrusage is only polled every 256 expansions
+    else if (options.time_limit >= 0 && wall_clock_seconds() - start_time > options.time_limit)
+        status = TIME_LIMIT;
+    else if (options.memory_limit >= 0 && num_expanded % 256 == 0 && peak_memory_kb() > options.memory_limit * 1024)
+        status = MEMORY_LIMIT;
+    return status == NODE_LIMIT || status == TIME_LIMIT || status == MEMORY_LIMIT;
+}
 
-    // Add effects of action to new state
-    for (GroundedCondition effect : a.get_effects())
+// A* search, weighted by options.weight. It stops as soon as a goal state is selected for
+// expansion, which makes the plan optimal for admissible heuristics with weight 1. Greedy
+// best-first search and the RWA* iterations use the same loop but already stop when a goal
+// is generated.
+// Each expansion first generates all successors and computes the heuristic of those whose
+// node would be updated, on eval_pool if there is one, then merges them in action order,
+// so the search is the same with any number of evaluation threads.
+void SymbolicPlanner::a_star_search()
+{
+    State current_state(this->task->num_atoms);
+    vector<int> applicable; // indices of actions applicable in current_state
+    vector<State> next_states; // applicable index, successor
+    vector<StateID> next_ids;
+    vector<int> next_h;
+    vector<int> to_evaluate; // applicable indices needing a heuristic value
+    function<void(size_t, int)> evaluate = [&](size_t i, int thread_index)
+    {
+        int k = to_evaluate[i];
+        next_h[k] = heuristic(next_states[k], this->eval_heuristics[thread_index]);
+    };
+
+    while(!open_list.empty())
     {
-        if(effect.get_truth())
+        if(limits_exceeded())
+            return;
+
+        // cout<<"Open list size: "<<open_list.size()<<endl;
+        // cout<<"Number of states: "<<state_registry.size()<<endl;
+        pair<int, StateID> current_node_idx = open_list.top();   //f-value, state id
+        open_list.pop();
+        StateID current_id = current_node_idx.second;
+        if(node_info[current_id].closed)
+            continue;
+        node_info[current_id].closed = true;
+        num_expanded++;
+
+        int current_g = node_info[current_id].g;
+        state_registry.get_state(current_id, current_state);
+        uint64_t current_hash = state_registry.get_hash(current_id);
+
+        // the goal test is a mask comparison, (state & goal) == goal.
+        // Goal states are not expanded.
+        if(goal_reached(current_state))
         {
-            new_node.state.insert(effect);
+            if(record_goal(current_id))
+                return;
+            continue;
         }
+
+        applicable.clear();
+        this->task->successor_generator.generate_applicable_actions(current_state, applicable);
+        num_generated += applicable.size();
+
+        // register the successors and find those the loop below will update
+        if(next_states.size() < applicable.size())
+            next_states.resize(applicable.size(), State(this->task->num_atoms));
+        next_ids.resize(applicable.size());
+        next_h.resize(applicable.size());
+        to_evaluate.clear();
+        for(size_t k = 0; k < applicable.size(); k++)
+        {
+            const GroundedAction& ga = this->task->actions[applicable[k]];
+            next_states[k] = current_state;
+            next_states[k].apply(ga.get_add_mask(), ga.get_delete_mask());
+            uint64_t next_hash = ga.successor_hash(current_hash, current_state, this->task->zobrist);
+            pair<StateID, bool> inserted = state_registry.insert_state(next_states[k], next_hash);
+            next_ids[k] = inserted.first;
+            if(inserted.second)
+            {
+                node_info.resize(state_registry.size());
+                parents.resize(state_registry.size());
+            }
+            else
+                stats.count(stats.duplicates);
+
+            const node& next = node_info[next_ids[k]];
+            if((!next.closed || options.engine == RWASTAR) && current_g + 1 < cost_bound && next.g > current_g + 1)
+            {
+                if(next.evaluated)
+                    next_h[k] = next.h;
+                else
+                    to_evaluate.push_back(k);
+            }
+        }
+
+        if(this->eval_pool)
+            this->eval_pool->parallel_for(to_evaluate.size(), evaluate);
         else
         {
-            effect.flip_truth();
-            new_node.state.erase(new_node.state.find(effect));
+            for(int k : to_evaluate)
+                next_h[k] = heuristic(next_states[k]);
+        }
+
+        for(size_t k = 0; k < applicable.size(); k++)
+        {
+            int action_count = applicable[k];
+            const State& next_state = next_states[k];
+            StateID next_id = next_ids[k];
+
+            // RWA* reopens closed nodes reached by a cheaper path, which it needs to
+            // find plans under the cost bound; the other engines never reopen
+            if(node_info[next_id].closed && options.engine != RWASTAR)
+                continue;
+
+            // cannot improve on the best plan found so far
+            if(current_g + 1 >= cost_bound)
+                continue;
+
+            // check if new node g-value is greater than current g-value + cost
+            if(node_info[next_id].g > current_g + 1)
+            {
+                node_info[next_id].h = next_h[k];
+                node_info[next_id].evaluated = true;
+                // with an admissible heuristic, g + h bounds the cost of every plan through the node
+                if(options.admissible() && current_g + 1 + next_h[k] >= cost_bound)
+                    continue;
+                if(node_info[next_id].closed)
+                    stats.count(stats.reopened);
+                node_info[next_id].g = current_g + 1;
+                parents[next_id].parent_id = current_id;
+                parents[next_id].action = action_count;
+                node_info[next_id].closed = false;
+                // GBFS and RWA* already stop when the goal is generated
+                if(options.engine != ASTAR && goal_reached(next_state))
+                {
+                    if(record_goal(next_id))
+                        return;
+                    continue;
+                }
+                open_node(next_id);
+            }
         }
+        stats.peak(stats.open_list_peak, open_list.size());
+    }
+    status = goal_ids.empty() ? UNSOLVABLE : SOLVED;
+}
+
+// Anytime restarting weighted A* (Richter, Thayer and Ruml 2010): run weighted A* with a
+// decreasing weight, restarting from the initial state each time and pruning paths that are
+// not cheaper than the best plan so far (on g + h if the heuristic is admissible, else on g).
+// Restarts keep the registered states and their heuristic values. The last weight (1) is repeated until the search space
+// is exhausted, which proves the last plan optimal, or until a limit is hit.
+void SymbolicPlanner::restarting_weighted_a_star()
+{
+    // start from options.weight if it is set above 1, then 5, 3, 2, 1
+    vector<int> weights;
+    if (options.weight > 1)
+        weights.push_back(options.weight);
+    for (int w : { 5, 3, 2, 1 })
+    {
+        if (weights.empty() || w < weights.back())
+            weights.push_back(w);
+    }
+
+    int saved_weight = options.weight;
+    cost_bound = numeric_limits<int>::max();
+    best_plan.clear();
+    plan_proven_optimal = false;
+    bool found_plan = false;
+    size_t iteration = 0;
+    while (true)
+    {
+        options.weight = weights[min(iteration, weights.size() - 1)];
+        // later iterations keep the states and heuristic values of the earlier ones
+        if (iteration == 0)
+            init_start_node();
+        else
+            restart_search();
+        status = SEARCHING;
+        a_star_search();
+        if (status != SOLVED)
+            break;
+
+        best_plan = backtrack();
+        found_plan = true;
+        cost_bound = best_plan.size();
+        if (on_plan_found)
+            on_plan_found(best_plan, options.weight);
+        // the initial state is a goal, no plan is cheaper
+        if (cost_bound == 0)
+            break;
+        iteration++;
     }
+    options.weight = saved_weight;
 
-    return new_node;
+    // exhausting the space (UNSOLVABLE) after a plan was found proves the plan optimal; a limit
+    // hit after a plan was found still returns that plan
+    if (found_plan)
+    {
+        plan_proven_optimal = status == UNSOLVABLE || cost_bound == 0;
+        status = SOLVED;
+    }
 }
 
-// Take relaxed action in given state
-SymbolicPlanner::node SymbolicPlanner::take_action_relaxed(node &n, GroundedAction &a)
+// Worker owning a state in HDA*. The registries index their tables with the low hash bits,
+// so the partition uses the high bits.
+int SymbolicPlanner::hda_owner(uint64_t hash, int num_workers)
 {
-    node new_node;
-    new_node.state = n.state;
+    return (hash >> 32) % num_workers;
+}
 
-    // Add effects of action to new state
-    for (GroundedCondition effect : a.get_effects())
+// Register a state generated with cost g in the worker that owns it and queue it if g improves
+// its node. Closed nodes are reopened: workers expand in parallel, so a state may be reached
+// by a cheaper path after it was expanded.
+void SymbolicPlanner::hda_insert(HDAWorker &worker, HDAShared &shared, const State &state, uint64_t hash, int g, int action, int parent_worker, StateID parent_id)
+{
+    pair<StateID, bool> inserted = worker.state_registry.insert_state(state, hash);
+    StateID id = inserted.first;
+    if (inserted.second)
     {
-        if(effect.get_truth())
-        {
-            new_node.state.insert(effect);
-        }
+        worker.node_info.resize(worker.state_registry.size());
+        worker.node_info[id].h = heuristic(state, worker.relaxed_heuristic);
     }
+    else
+        stats.count(stats.duplicates);
 
-    return new_node;
+    HDANode& n = worker.node_info[id];
+    if (g >= n.g)
+        return;
+    if (n.closed)
+        stats.count(stats.reopened);
+    n.g = g;
+    n.parent.parent_id = parent_id;
+    n.parent.action = action;
+    n.parent_worker = parent_worker;
+    n.closed = false;
+
+    // goal unreachable from here, or cannot improve on the best plan found so far
+    if (n.h == DEAD_END || g + n.h >= shared.incumbent.load(memory_order_relaxed))
+        return;
+    worker.open_list.push(f_value(n.g, n.h), n.h, id);
 }
 
-// Check if goal reached
-bool SymbolicPlanner::goal_reached(unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> &state)
+// Send the buffered messages of worker_id to their owners, skipping batches smaller than min_size
+void SymbolicPlanner::hda_flush(vector<unique_ptr<HDAWorker>> &workers, int worker_id, HDAShared &shared, size_t min_size)
 {
-    for (GroundedCondition goal : this->env->get_goal_conditions())
+    HDAWorker& worker = *workers[worker_id];
+    for (size_t owner = 0; owner < workers.size(); owner++)
     {
-        if (state.find(goal) == state.end())
-            return false;
+        HDAMessageBatch& batch = worker.outbox[owner];
+        if (batch.messages.empty() || batch.messages.size() < min_size)
+            continue;
+        // counted before it can be received, so work_count never drops to 0 while it is in flight
+        shared.work_count.fetch_add(batch.messages.size());
+        workers[owner]->inbox.push(move(batch));
+        batch = HDAMessageBatch();
     }
-    return true;
 }
 
-// A* search
-void SymbolicPlanner::a_star_search()
+// Search loop of one HDA* thread: receive states, expand the best local node and forward the
+// successors owned by other workers. The search ends once no worker has work and no message
+// is in flight (work_count == 0), or when a limit is hit.
+void SymbolicPlanner::hda_worker(vector<unique_ptr<HDAWorker>> &workers, int worker_id, HDAShared &shared)
 {
-    auto goal_state = this->env->get_goal_conditions();
-    string goal_str = condition_to_string(goal_state);
-    while(!open_list.empty())
+    HDAWorker& worker = *workers[worker_id];
+    int num_workers = workers.size();
+    State current_state(this->task->num_atoms);
+    State received_state(this->task->num_atoms);
+    size_t num_words = current_state.num_words();
+    HDAMessageBatch batch;
+    vector<int> applicable; // indices of actions applicable in current_state
+
+    while (!shared.done.load(memory_order_acquire))
     {
-        // cout<<"Open list size: "<<open_list.size()<<endl;
-        // cout<<"Closed list size: "<<closed_list.size()<<endl;
-        pair<int, string> current_node_idx = open_list.top();   //f-value, cell state
-        open_list.pop();
-        string current_node_str = current_node_idx.second;
-        if(in_closed_list(closed_list, current_node_str))
+        // states sent by the other workers
+        while (worker.inbox.pop(batch))
+        {
+            if (!worker.active)
+            {
+                worker.active = true;
+                shared.work_count.fetch_add(1);
+            }
+            for (size_t i = 0; i < batch.messages.size(); i++)
+            {
+                const HDAMessage& m = batch.messages[i];
+                received_state.set_words(&batch.words[i * num_words]);
+                hda_insert(worker, shared, received_state, m.hash, m.g, m.action, m.parent_worker, m.parent_id);
+            }
+            shared.work_count.fetch_sub(batch.messages.size());
+        }
+
+        // drop closed and outdated entries, and nodes that cannot lead to a cheaper plan
+        while (!worker.open_list.empty())
+        {
+            pair<int, StateID> top = worker.open_list.top();
+            const HDANode& n = worker.node_info[top.second];
+            if (!n.closed && top.first == f_value(n.g, n.h) && n.g + n.h < shared.incumbent.load(memory_order_relaxed))
+                break;
+            worker.open_list.pop();
+        }
+
+        if (worker.open_list.empty())
+        {
+            // idle: hand out everything buffered, then check whether any work is left
+            hda_flush(workers, worker_id, shared, 1);
+            if (worker.active)
+            {
+                worker.active = false;
+                shared.work_count.fetch_sub(1);
+            }
+            if (shared.work_count.load() == 0)
+            {
+                shared.done.store(true, memory_order_release);
+                break;
+            }
+            this_thread::yield();
             continue;
-        closed_list.insert(current_node_str);
+        }
+
+        // node, time and memory limits
+        SearchStatus stop = SEARCHING;
+        long total_expanded = shared.total_expanded.fetch_add(1, memory_order_relaxed);
+        if (options.node_limit >= 0 && total_expanded >= options.node_limit)
+            stop = NODE_LIMIT;
+        else if (options.time_limit >= 0 && wall_clock_seconds() - start_time > options.time_limit)
+            stop = TIME_LIMIT;
+        else if (options.memory_limit >= 0 && worker.num_expanded % 256 == 0 && peak_memory_kb() > options.memory_limit * 1024)
+            stop = MEMORY_LIMIT;
+        if (stop != SEARCHING)
+        {
+            int expected = SEARCHING;
+            shared.stop_status.compare_exchange_strong(expected, stop);
+            shared.done.store(true, memory_order_release);
+            break;
+        }
 
-        node current_node = this->node_info[current_node_str];
+        StateID current_id = worker.open_list.top().second;
+        worker.open_list.pop();
+        worker.node_info[current_id].closed = true;
+        worker.num_expanded++;
 
-        int action_count = -1;
+        int current_g = worker.node_info[current_id].g;
+        worker.state_registry.get_state(current_id, current_state);
 
-        for(GroundedAction ga : this->grounded_actions)
+        // goals are detected on expansion: all nodes with f below the incumbent
+        // are expanded before the search ends, so the last incumbent is optimal
+        if (goal_reached(current_state))
         {
-            ++action_count;
-            if(this->is_action_valid(current_node.state, ga))
+            lock_guard<mutex> lock(shared.goal_mutex);
+            if (shared.first_goal_expansions < 0)
+                shared.first_goal_expansions = total_expanded + 1;
+            if (current_g < shared.incumbent.load())
             {
-                node next_node = this->take_action(current_node, ga);
-                string next_node_str = condition_to_string(next_node.state);
+                shared.incumbent.store(current_g);
+                shared.goal_worker = worker_id;
+                shared.goal_id = current_id;
+            }
+            continue;
+        }
 
-                if(in_closed_list(closed_list, next_node_str))
-                    continue;
+        uint64_t current_hash = worker.state_registry.get_hash(current_id);
+        applicable.clear();
+        this->task->successor_generator.generate_applicable_actions(current_state, applicable);
+        worker.num_generated += applicable.size();
 
-                // check if new node g-value is greater than current g-value + cost
-                if(node_info[next_node_str].g > current_node.g + 1)
-                {
-                    // break if goal reached
-                    if(goal_reached(next_node.state))
-                    {
-                        node_info[goal_str].g = current_node.g + 1;
-                        node_info[goal_str].h = heuristic(next_node.state);
-                        node_info[goal_str].parent = action_count;
-                        node_info[goal_str].state = next_node.state;
-                        node_info[goal_str].parent_node_str = current_node_str;
-                        break;
-                    }
-                    node_info[next_node_str].g = current_node.g + 1;
-                    node_info[next_node_str].h = heuristic(next_node.state);
-                    node_info[next_node_str].parent = action_count;
-                    node_info[next_node_str].state = next_node.state;
-                    node_info[next_node_str].parent_node_str = current_node_str;
-                    int f = node_info[next_node_str].g + node_info[next_node_str].h;
-                    open_list.push(make_pair(f, next_node_str));
-                }
+        for (int action_count : applicable)
+        {
+            const GroundedAction& ga = this->task->actions[action_count];
+            State next_state = this->take_action(current_state, ga);
+            uint64_t next_hash = ga.successor_hash(current_hash, current_state, this->task->zobrist);
+            int owner = hda_owner(next_hash, num_workers);
+            if (owner == worker_id)
+            {
+                hda_insert(worker, shared, next_state, next_hash, current_g + 1, action_count, worker_id, current_id);
+                continue;
             }
+
+            HDAMessageBatch& out = worker.outbox[owner];
+            out.messages.push_back(HDAMessage{ next_hash, current_g + 1, action_count, worker_id, current_id });
+            out.words.insert(out.words.end(), next_state.get_words().begin(), next_state.get_words().end());
         }
+        hda_flush(workers, worker_id, shared, HDA_BATCH_SIZE);
+        stats.peak(stats.open_list_peak, worker.open_list.size());
     }
 }
 
+// Hash Distributed A* (Kishimoto, Fukunaga and Botea 2009). Every thread owns the states whose
+// hash maps to it and runs A* on them; successors owned by another thread are sent to it through
+// a lock-free queue. Plans are optimal for admissible heuristics (zero, hmax) with weight 1;
+// the other heuristics (edl included) can overestimate and give longer plans.
+list<GroundedAction> SymbolicPlanner::hash_distributed_a_star()
+{
+    int num_workers = options.threads;
+    if (num_workers <= 0)
+        num_workers = max(1u, thread::hardware_concurrency());
+
+    HDAShared shared;
+    shared.work_count = num_workers;
+    shared.done = false;
+    shared.total_expanded = 0;
+    shared.stop_status = SEARCHING;
+    shared.incumbent = numeric_limits<int>::max();
+
+    vector<unique_ptr<HDAWorker>> workers;
+    for (int i = 0; i < num_workers; i++)
+    {
+        unique_ptr<HDAWorker> worker(new HDAWorker());
+        worker->state_registry = StateRegistry(this->task->zobrist, this->task->num_atoms);
+        worker->outbox.resize(num_workers);
+        worker->relaxed_heuristic = this->relaxed_heuristic;
+        workers.push_back(move(worker));
+    }
+
+    // The initial state starts in the worker that owns it
+    State init_state(this->task->num_atoms, this->initial_atoms);
+    uint64_t init_hash = this->task->zobrist.hash_state(init_state);
+    hda_insert(*workers[hda_owner(init_hash, num_workers)], shared, init_state, init_hash, 0, -1, -1, NO_STATE);
+
+    vector<thread> threads;
+    for (int i = 0; i < num_workers; i++)
+        threads.push_back(thread(&SymbolicPlanner::hda_worker, this, ref(workers), i, ref(shared)));
+    for (thread& t : threads)
+        t.join();
+
+    num_expanded = 0;
+    num_generated = 0;
+    for (const unique_ptr<HDAWorker>& worker : workers)
+    {
+        num_expanded += worker->num_expanded;
+        num_generated += worker->num_generated;
+    }
+
+    if (shared.stop_status != SEARCHING)
+        status = (SearchStatus)shared.stop_status.load();
+    else
+        status = shared.goal_id == NO_STATE ? UNSOLVABLE : SOLVED;
+
+    // follow the parents of the goal across workers back to the initial state
+    vector<pair<int, StateID>> path; // worker, state id; from the goal back to the initial state
+    int current_worker = shared.goal_worker;
+    StateID current_id = shared.goal_id;
+    while (current_id != NO_STATE)
+    {
+        path.push_back(make_pair(current_worker, current_id));
+        const HDANode& n = workers[current_worker]->node_info[current_id];
+        current_worker = n.parent_worker;
+        current_id = n.parent.parent_id;
+    }
+
+    // register the path in this planner's own search context, so that start_id, goal_ids and
+    // the nodes and parents along the plan are the same as after A*, and backtrack from there
+    state_registry.clear();
+    node_info.clear();
+    parents.clear();
+    goal_ids.clear();
+    first_goal_expansions = shared.first_goal_expansions;
+    start_id = state_registry.insert_state(init_state, init_hash).first;
+    node_info.resize(state_registry.size());
+    parents.resize(state_registry.size());
+    node_info[start_id].g = 0;
+    StateID parent_id = start_id;
+    State state(this->task->num_atoms);
+    for (int i = (int)path.size() - 2; i >= 0; i--)
+    {
+        const HDAWorker& worker = *workers[path[i].first];
+        const HDANode& n = worker.node_info[path[i].second];
+        worker.state_registry.get_state(path[i].second, state);
+        StateID id = state_registry.insert_state(state, worker.state_registry.get_hash(path[i].second)).first;
+        node_info.resize(state_registry.size());
+        parents.resize(state_registry.size());
+        node_info[id].g = n.g;
+        node_info[id].h = n.h;
+        node_info[id].closed = true;
+        parents[id].parent_id = parent_id;
+        parents[id].action = n.parent.action;
+        parent_id = id;
+    }
+    if (!path.empty())
+        goal_ids.push_back(parent_id);
+    return backtrack();
+}
+
+// Run the configured search engine from the initial state and return the plan (empty if none)
+list<GroundedAction> SymbolicPlanner::search()
+{
+    PhaseTimer timer(stats.search_time);
+    if (options.engine == HDASTAR)
+        return hash_distributed_a_star();
+
+    if (options.engine == RWASTAR)
+    {
+        restarting_weighted_a_star();
+        return best_plan;
+    }
+
+    init_start_node();
+    a_star_search();
+    return backtrack();
+}
+
 list<GroundedAction> planner(Env* env)
 {
-    SymbolicPlanner planner = SymbolicPlanner(env);
+    SymbolicPlanner planner = SymbolicPlanner(env, search_options);
+    planner.stats.parse_time = env_parse_time;
     cout << endl;
 
     clock_t t;
     t = clock();
 
-    // Compute all possible grounded actions
-    planner.compute_all_grounded_actions();
+    // Compute all possible grounded actions, or take them from the task cache
+    if (task_cache.hit())
+        planner.set_grounded_actions(task_cache.grounded_actions(), task_cache.static_blockers());
+    else
+    {
+        planner.compute_all_grounded_actions();
+        if (task_cache.enabled() && !task_cache.store(*env, planner.get_grounded_actions(), planner.get_task()->static_blockers))
+            cout<<"Unable to write the task cache"<<endl;
+    }
 
     // print all grounded actions
     if(debug)
     {
         cout << "ALL Grounded Actions:" << endl;
-        for (GroundedAction ga : planner.get_grounded_actions())
+        for (const GroundedAction& ga : planner.get_grounded_actions())
         {
             cout << ga;
         }
@@ -409,15 +1017,36 @@ list<GroundedAction> planner(Env* env)
 
     cout<<"Number of possible actions: "<<planner.get_grounded_actions().size()<<endl;
     
-    planner.init_start_node();
+    // report every improved plan of the anytime search
+    double search_start = wall_clock_seconds();
+    planner.on_plan_found = [search_start](const list<GroundedAction>& plan, int weight)
+    {
+        cout<<"Found plan of length "<<plan.size()<<" with weight "<<weight<<" after "
+            <<wall_clock_seconds() - search_start<<" seconds"<<endl;
+    };
 
-    // Perform A* search
-    planner.a_star_search();
-    cout<<"Number of states expanded: "<<planner.closed_list.size()<<endl;
+    // Perform the search
+    list<GroundedAction> actions = planner.search();
+    cout<<"Number of states expanded: "<<planner.num_expanded<<endl;
+    if(planner.status == NODE_LIMIT)
+        cout<<"Search stopped: node limit reached"<<endl;
+    else if(planner.status == TIME_LIMIT)
+        cout<<"Search stopped: time limit reached"<<endl;
+    else if(planner.status == MEMORY_LIMIT)
+        cout<<"Search stopped: memory limit reached"<<endl;
+    else if(planner.status == UNSOLVABLE)
+        cout<<"No plan exists"<<endl;
+    else if(planner.options.engine == RWASTAR && !planner.plan_proven_optimal)
+        cout<<"Search stopped by a limit: plan not proven optimal"<<endl;
+    if(!planner.goal_ids.empty())
+        cout<<"Goal states found: "<<planner.goal_ids.size()<<" (first after "<<planner.first_goal_expansions<<" expansions)"<<endl;
 
-    list<GroundedAction> actions;
-    // Backtrack to get the plan
-    actions = planner.backtrack();
+    if(STATS_ENABLED)
+    {
+        cout<<"Stats: ";
+        planner.stats.dump(cout, planner.num_expanded, planner.num_generated);
+        cout<<endl;
+    }
 
     t = clock() - t;
     cout<<"Time Taken: "<<((float)t)/CLOCKS_PER_SEC<<" seconds\n";
@@ -431,6 +1060,8 @@ list<GroundedAction> planner(Env* env)
     return actions;
 }
 
+// planner_cli.cpp provides its own main with command line options
+#ifndef PLANNER_NO_MAIN
 int main(int argc, char* argv[])
 {
     // DO NOT CHANGE THIS FUNCTION
@@ -454,4 +1085,5 @@ int main(int argc, char* argv[])
     }
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
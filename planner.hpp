@@ -1,422 +1,582 @@
 #include <iostream>
 #include <fstream>
 // #include <boost/functional/hash.hpp>
-#include <regex>
 #include <set>
 #include <algorithm>
 #include <stdexcept>
 #include <queue>
+#include <functional>
+#include <limits>
+#include <cassert>
 #include <time.h>
 #include "env.hpp"
-
-#define SYMBOLS 0
-#define INITIAL 1
-#define GOAL 2
-#define ACTIONS 3
-#define ACTION_DEFINITION 4
-#define ACTION_PRECONDITION 5
-#define ACTION_EFFECT 6
-
-// For our vector subset, at every step we have A.size()-i-1
-// choices to include. A loop helps us to choose each element
-// and then move to the indices further present in the array.
-// At the end we backtrack to choose a different index.
-void comb_util(vector<string>& A, vector<vector<string> >& res,
-                 vector<string>& subset, int index)
+#include "parser.hpp"
+#include "task_cache.hpp"
+#include "arena.hpp"
+#include "state_registry.hpp"
+#include "successor_generator.hpp"
+#include "open_list.hpp"
+#include "relaxed_heuristics.hpp"
+#include "resource_usage.hpp"
+#include "stats.hpp"
+#include "plan_cache.hpp"
+#include "hda_star.hpp"
+#include "thread_pool.hpp"
+
+// Streams all k-permutations (ordered k-tuples of distinct elements) of {0, ..., n-1}
+// in lexicographic order. The tuple is updated in place, so nothing is allocated per tuple.
+//
+//     KPermutations perms(n, k);
+//     while (perms.next())
+//         use(perms.current());
+class KPermutations
 {
-    res.push_back(subset);
-      // Loop to choose from different elements present
-      // after the current index 'index'
-    for (int i = index; i < A.size(); i++) 
+private:
+    int n;
+    int k;
+    vector<int> tuple;
+    vector<char> used; // element, in the current tuple
+    bool started = false;
+
+public:
+    KPermutations(int n, int k)
     {
-        // include the A[i] in subset.
-        subset.push_back(A[i]);
- 
-        // move onto the next element.
-        comb_util(A, res, subset, i + 1);
- 
-        // exclude the A[i] from subset and triggers
-        // backtracking.
-        subset.pop_back();
+        this->n = n;
+        this->k = k;
+        this->tuple.assign(max(k, 0), 0);
+        this->used.assign(max(n, 0), 0);
     }
-    return;
-}
- 
-// Combination code modified from GeeksforGeeks example
-// Find and return all combinations of symbols that can be picked. 
-vector<vector<string>> combinations(vector<string>& A, int n)
-{
-    vector<string> subset;
-    vector<vector<string> > res;
- 
-    // keeps track of current element in vector A
-    // and the number of elements present in the array subset
-    int index = 0;
-    comb_util(A, res, subset, index);
-    
-    vector<vector<string>> ret;
-    
-    // Only return combinations whose size is n
-    for(int i=0; i<res.size(); i++)
+
+    // Advance to the next tuple, false once all tuples were produced
+    bool next()
     {
-        if(res[i].size()==n)
+        if (!this->started)
         {
-            ret.push_back(res[i]);
+            this->started = true;
+            if (this->k > this->n)
+                return false;
+            for (int i = 0; i < this->k; i++)
+            {
+                this->tuple[i] = i;
+                this->used[i] = 1;
+            }
+            return true;
+        }
+
+        // Increment the rightmost position that can take a larger unused element,
+        // then refill the positions after it with the smallest unused elements
+        for (int i = this->k - 1; i >= 0; i--)
+        {
+            this->used[this->tuple[i]] = 0;
+            int v = this->tuple[i] + 1;
+            while (v < this->n && this->used[v])
+                v++;
+            if (v == this->n)
+                continue;
+
+            this->tuple[i] = v;
+            this->used[v] = 1;
+            for (int j = i + 1; j < this->k; j++)
+            {
+                int u = 0;
+                while (this->used[u])
+                    u++;
+                this->tuple[j] = u;
+                this->used[u] = 1;
+            }
+            return true;
         }
+        return false;
     }
-    return ret;
-}
 
-// Generates permutations of a string vector using Heap's algorithm
-void permute(vector<string> a, vector<vector<string>> &all_permutations, int l, int r)
-{
-	if (l == r)
-		all_permutations.push_back(a);
-	else {
-		for (int i = l; i <= r; i++) {
-			swap(a[l], a[i]);
-			permute(a, all_permutations, l + 1, r);
-			swap(a[l], a[i]);
-		}
-	}
-}
+    const vector<int>& current() const
+    {
+        return this->tuple;
+    }
+};
 
-string condition_to_string(unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator>& stateset)
+// A condition of an action schema compiled to interned ids.
+// args >= 0 index the action parameters, args < 0 are constant symbols (-(symbol id) - 1).
+struct CompiledCondition
 {
-    set<string> state;
-    string string_return = "";
-
-    for(GroundedCondition gc : stateset)
-        state.insert(gc.toString());
-    for (auto it = state.begin(); it != state.end(); it++) 
-        string_return += *it; 
-    return string_return;
-}
+    int predicate;
+    vector<int> args;
+    bool truth;
+    bool is_static = false; // no action changes this predicate
+};
 
-class SymbolicPlanner
+struct CompiledAction
 {
-    private:
-        vector<GroundedAction> grounded_actions;
-        Env* env;
+    int num_params;
+    vector<CompiledCondition> preconditions; // positive static, positive fluent, negative
+    vector<CompiledCondition> effects;
+};
 
-    public:
-        SymbolicPlanner(Env* env)
+// Grounds action schemas by relaxed reachability. Starting from the initial state, an action is
+// only instantiated once all its positive preconditions are reachable: each precondition is joined
+// against the reachable facts of its predicate, so static preconditions (e.g. Block(x)) only match
+// the initial state. The effects of new actions make more facts reachable until a fixpoint.
+// As before, all arguments of a grounded action are distinct symbols.
+class Grounder
+{
+private:
+    AtomTable* atoms;
+    vector<CompiledAction> schemas;
+    vector<int> symbol_ids; // all symbols
+    vector<char> initial; // atom id, true in the initial state
+    vector<char> reachable; // atom id, reachable in the relaxed task
+    vector<vector<int>> facts_by_predicate; // predicate id, reachable atom ids
+    set<int> static_blockers; // initial atoms that failed a static negative precondition
+
+    CompiledCondition compile_condition(const Condition& c, const vector<string>& params)
+    {
+        CompiledCondition cc;
+        cc.predicate = this->atoms->intern_predicate(c.get_predicate());
+        cc.truth = c.get_truth();
+        for (const string& arg : c.get_args())
         {
-            this->env = env;
+            auto it = find(params.begin(), params.end(), arg);
+            if (it != params.end())
+                cc.args.push_back(it - params.begin());
+            else
+                cc.args.push_back(-this->atoms->intern_symbol(arg) - 1);
         }
-        struct node
-        {
-            unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> state;
-            int g = std::numeric_limits<int>::max();
-            int h = 0;
-        
-            int parent = -1; // state of previous(parent) node
-            string parent_node_str = "";
-        };
+        return cc;
+    }
 
-        unordered_set<string> closed_list; // idx of expanded nodes
-        unordered_map<string, node> node_info; // idx, node
-        unordered_map<string, int> state_map; // string_state, idx
+    bool add_fact(int atom_id)
+    {
+        if (atom_id >= (int)this->reachable.size())
+            this->reachable.resize(atom_id + 1, 0);
+        if (this->reachable[atom_id])
+            return false;
+        this->reachable[atom_id] = 1;
+        int predicate = this->atoms->atom_predicate(atom_id);
+        if (predicate >= (int)this->facts_by_predicate.size())
+            this->facts_by_predicate.resize(predicate + 1);
+        this->facts_by_predicate[predicate].push_back(atom_id);
+        return true;
+    }
 
-        // f value, string state: sorted according to f value
-        priority_queue<pair<int, string>, vector<pair<int, string>>, greater<pair<int, string>>> open_list;
-        vector<GroundedAction> get_grounded_actions() const
+    // Symbol ids of the arguments of condition c under binding
+    vector<int> condition_args(const CompiledCondition& c, const vector<int>& binding)
+    {
+        vector<int> args;
+        for (int arg : c.args)
+            args.push_back(arg >= 0 ? binding[arg] : -arg - 1);
+        return args;
+    }
+
+    // Negative preconditions on static predicates can be decided in the initial state
+    bool static_negatives_hold(const CompiledAction& ca, const vector<int>& binding)
+    {
+        for (const CompiledCondition& c : ca.preconditions)
         {
-            return this->grounded_actions;
+            if (c.truth || !c.is_static)
+                continue;
+            int atom_id = this->atoms->find_atom(c.predicate, condition_args(c, binding));
+            if (atom_id >= 0 && atom_id < (int)this->initial.size() && this->initial[atom_id])
+            {
+                this->static_blockers.insert(atom_id);
+                return false;
+            }
         }
+        return true;
+    }
 
-        list<GroundedAction> backtrack();
-        void compute_all_grounded_actions();
-        int heuristic(unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> &state);
-        int simple_heur(unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> &state);
-        int empty_delete_list_heur(unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> &state);
-        void init_start_node();
-        bool in_closed_list(unordered_set<string> &closed_list, string &idx);
-        bool is_action_valid(unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> &state, GroundedAction &action);
-        node take_action(node &n, GroundedAction &a);
-        bool goal_reached(unordered_set<GroundedCondition, GroundedConditionHasher, GroundedConditionComparator> &state);
-        void a_star_search();
-        node take_action_relaxed(node &n, GroundedAction &a);
+    // Fill the parameters not bound by any positive precondition with distinct unused symbols
+    void bind_free_params(const CompiledAction& ca, vector<int>& binding, vector<vector<int>>& bindings)
+    {
+        vector<int> free_params;
+        for (int p = 0; p < ca.num_params; p++)
+        {
+            if (binding[p] < 0)
+                free_params.push_back(p);
+        }
+        if (free_params.empty())
+        {
+            if (static_negatives_hold(ca, binding))
+                bindings.push_back(binding);
+            return;
+        }
 
-        // list<GroundedAction> backtrack();
-};
+        vector<int> unused;
+        for (int symbol_id : this->symbol_ids)
+        {
+            if (find(binding.begin(), binding.end(), symbol_id) == binding.end())
+                unused.push_back(symbol_id);
+        }
 
-list<string> parse_symbols(string symbols_str)
-{
-    list<string> symbols;
-    size_t pos = 0;
-    string delimiter = ",";
-    while ((pos = symbols_str.find(delimiter)) != string::npos)
-    {
-        string symbol = symbols_str.substr(0, pos);
-        symbols_str.erase(0, pos + delimiter.length());
-        symbols.push_back(symbol);
+        // Stream the argument tuples of the free parameters
+        KPermutations perms(unused.size(), free_params.size());
+        while (perms.next())
+        {
+            const vector<int>& tuple = perms.current();
+            for (size_t i = 0; i < free_params.size(); i++)
+                binding[free_params[i]] = unused[tuple[i]];
+            if (static_negatives_hold(ca, binding))
+                bindings.push_back(binding);
+        }
+        for (int p : free_params)
+            binding[p] = -1;
     }
-    symbols.push_back(symbols_str);
-    return symbols;
-}
 
-Env* create_env(char* filename)
-{
-    ifstream input_file(filename);
-    Env* env = new Env();
-    regex symbolStateRegex("symbols:", regex::icase);
-    regex symbolRegex("([a-zA-Z0-9_, ]+) *");
-    regex initialConditionRegex("initialconditions:(.*)", regex::icase);
-    regex conditionRegex("(!?[A-Z][a-zA-Z_]*) *\\( *([a-zA-Z0-9_, ]+) *\\)");
-    regex goalConditionRegex("goalconditions:(.*)", regex::icase);
-    regex actionRegex("actions:", regex::icase);
-    regex precondRegex("preconditions:(.*)", regex::icase);
-    regex effectRegex("effects:(.*)", regex::icase);
-    int parser = SYMBOLS;
-
-    unordered_set<Condition, ConditionHasher, ConditionComparator> preconditions;
-    unordered_set<Condition, ConditionHasher, ConditionComparator> effects;
-    string action_name;
-    string action_args;
-
-    string line;
-    if (input_file.is_open())
+    // Join positive precondition k onwards against the reachable facts
+    void bind_preconditions(const CompiledAction& ca, size_t k, vector<int>& binding, vector<vector<int>>& bindings)
     {
-        while (getline(input_file, line))
+        if (k == ca.preconditions.size() || !ca.preconditions[k].truth)
         {
-            string::iterator end_pos = remove(line.begin(), line.end(), ' ');
-            line.erase(end_pos, line.end());
+            bind_free_params(ca, binding, bindings);
+            return;
+        }
 
-            if (line == "")
+        const CompiledCondition& c = ca.preconditions[k];
+        if (c.predicate >= (int)this->facts_by_predicate.size())
+            return;
+
+        vector<int> newly_bound;
+        for (int atom_id : this->facts_by_predicate[c.predicate])
+        {
+            const vector<int>& key = this->atoms->atom_key(atom_id);
+            if (key.size() != c.args.size() + 1)
                 continue;
 
-            if (parser == SYMBOLS)
+            bool match = true;
+            for (size_t i = 0; i < c.args.size() && match; i++)
             {
-                smatch results;
-                if (regex_search(line, results, symbolStateRegex))
-                {
-                    line = line.substr(8);
-                    sregex_token_iterator iter(line.begin(), line.end(), symbolRegex, 0);
-                    sregex_token_iterator end;
-
-                    env->add_symbols(parse_symbols(iter->str()));  // fixed
-
-                    parser = INITIAL;
-                }
+                int symbol = key[i + 1];
+                int arg = c.args[i];
+                if (arg < 0)
+                    match = (symbol == -arg - 1);
+                else if (binding[arg] >= 0)
+                    match = (binding[arg] == symbol);
+                else if (find(binding.begin(), binding.end(), symbol) != binding.end())
+                    match = false; // arguments must be distinct
                 else
                 {
-                    cout << "Symbols are not specified correctly." << endl;
-                    throw;
+                    binding[arg] = symbol;
+                    newly_bound.push_back(arg);
                 }
             }
-            else if (parser == INITIAL)
-            {
-                const char* line_c = line.c_str();
-                if (regex_match(line_c, initialConditionRegex))
-                {
-                    const std::vector<int> submatches = { 1, 2 };
-                    sregex_token_iterator iter(
-                        line.begin(), line.end(), conditionRegex, submatches);
-                    sregex_token_iterator end;
 
-                    while (iter != end)
-                    {
-                        // name
-                        string predicate = iter->str();
-                        iter++;
-                        // args
-                        string args = iter->str();
-                        iter++;
-
-                        if (predicate[0] == '!')
-                        {
-                            env->remove_initial_condition(
-                                GroundedCondition(predicate.substr(1), parse_symbols(args)));
-                        }
-                        else
-                        {
-                            env->add_initial_condition(
-                                GroundedCondition(predicate, parse_symbols(args)));
-                        }
-                    }
+            if (match)
+                bind_preconditions(ca, k + 1, binding, bindings);
 
-                    parser = GOAL;
-                }
-                else
-                {
-                    cout << "Initial conditions not specified correctly." << endl;
-                    throw;
-                }
-            }
-            else if (parser == GOAL)
-            {
-                const char* line_c = line.c_str();
-                if (regex_match(line_c, goalConditionRegex))
-                {
-                    const std::vector<int> submatches = { 1, 2 };
-                    sregex_token_iterator iter(
-                        line.begin(), line.end(), conditionRegex, submatches);
-                    sregex_token_iterator end;
+            for (int p : newly_bound)
+                binding[p] = -1;
+            newly_bound.clear();
+        }
+    }
 
-                    while (iter != end)
-                    {
-                        // name
-                        string predicate = iter->str();
-                        iter++;
-                        // args
-                        string args = iter->str();
-                        iter++;
-
-                        if (predicate[0] == '!')
-                        {
-                            env->remove_goal_condition(
-                                GroundedCondition(predicate.substr(1), parse_symbols(args)));
-                        }
-                        else
-                        {
-                            env->add_goal_condition(
-                                GroundedCondition(predicate, parse_symbols(args)));
-                        }
-                    }
+public:
+    Grounder(Env* env, const vector<Action>& actions)
+    {
+        this->atoms = &env->get_atoms();
+        for (const string& s : env->get_symbols())
+            this->symbol_ids.push_back(this->atoms->intern_symbol(s));
 
-                    parser = ACTIONS;
-                }
-                else
-                {
-                    cout << "Goal conditions not specified correctly." << endl;
-                    throw;
-                }
-            }
-            else if (parser == ACTIONS)
-            {
-                const char* line_c = line.c_str();
-                if (regex_match(line_c, actionRegex))
-                {
-                    parser = ACTION_DEFINITION;
-                }
-                else
-                {
-                    cout << "Actions not specified correctly." << endl;
-                    throw;
-                }
-            }
-            else if (parser == ACTION_DEFINITION)
+        unordered_set<int> fluent_predicates;
+        for (const Action& a : actions)
+        {
+            vector<string> params;
+            for (const string& arg : a.get_args())
+                params.push_back(arg);
+
+            CompiledAction ca;
+            ca.num_params = params.size();
+            for (const Condition& c : a.get_preconditions())
+                ca.preconditions.push_back(compile_condition(c, params));
+            for (const Condition& c : a.get_effects())
             {
-                const char* line_c = line.c_str();
-                if (regex_match(line_c, conditionRegex))
-                {
-                    const std::vector<int> submatches = { 1, 2 };
-                    sregex_token_iterator iter(
-                        line.begin(), line.end(), conditionRegex, submatches);
-                    sregex_token_iterator end;
-                    // name
-                    action_name = iter->str();
-                    iter++;
-                    // args
-                    action_args = iter->str();
-                    iter++;
-
-                    parser = ACTION_PRECONDITION;
-                }
-                else
-                {
-                    cout << "Action not specified correctly." << endl;
-                    throw;
-                }
+                ca.effects.push_back(compile_condition(c, params));
+                fluent_predicates.insert(ca.effects.back().predicate);
             }
-            else if (parser == ACTION_PRECONDITION)
-            {
-                const char* line_c = line.c_str();
-                if (regex_match(line_c, precondRegex))
+            this->schemas.push_back(ca);
+        }
+
+        for (CompiledAction& ca : this->schemas)
+        {
+            for (CompiledCondition& c : ca.preconditions)
+                c.is_static = fluent_predicates.count(c.predicate) == 0;
+            stable_sort(ca.preconditions.begin(), ca.preconditions.end(),
+                [](const CompiledCondition& a, const CompiledCondition& b)
                 {
-                    const std::vector<int> submatches = { 1, 2 };
-                    sregex_token_iterator iter(
-                        line.begin(), line.end(), conditionRegex, submatches);
-                    sregex_token_iterator end;
+                    return make_pair(!a.truth, !a.is_static) < make_pair(!b.truth, !b.is_static);
+                });
+        }
 
-                    while (iter != end)
-                    {
-                        // name
-                        string predicate = iter->str();
-                        iter++;
-                        // args
-                        string args = iter->str();
-                        iter++;
-
-                        bool truth;
-
-                        if (predicate[0] == '!')
-                        {
-                            predicate = predicate.substr(1);
-                            truth = false;
-                        }
-                        else
-                        {
-                            truth = true;
-                        }
-
-                        Condition precond(predicate, parse_symbols(args), truth);
-                        preconditions.insert(precond);
-                    }
+        for (int atom_id : env->get_initial_atoms())
+        {
+            if (atom_id >= (int)this->initial.size())
+                this->initial.resize(atom_id + 1, 0);
+            this->initial[atom_id] = 1;
+            add_fact(atom_id);
+        }
+    }
 
-                    parser = ACTION_EFFECT;
-                }
-                else
-                {
-                    cout << "Precondition not specified correctly." << endl;
-                    throw;
-                }
-            }
-            else if (parser == ACTION_EFFECT)
+    // Returns, for each action, the argument bindings (symbol id per parameter) of all reachable instances
+    vector<vector<vector<int>>> ground()
+    {
+        vector<vector<vector<int>>> bindings(this->schemas.size());
+        vector<unordered_set<vector<int>, AtomKeyHasher>> seen(this->schemas.size());
+
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (size_t i = 0; i < this->schemas.size(); i++)
             {
-                const char* line_c = line.c_str();
-                if (regex_match(line_c, effectRegex))
-                {
-                    const std::vector<int> submatches = { 1, 2 };
-                    sregex_token_iterator iter(
-                        line.begin(), line.end(), conditionRegex, submatches);
-                    sregex_token_iterator end;
+                const CompiledAction& ca = this->schemas[i];
+                vector<int> binding(ca.num_params, -1);
+                vector<vector<int>> found;
+                bind_preconditions(ca, 0, binding, found);
 
-                    while (iter != end)
+                for (const vector<int>& b : found)
+                {
+                    if (!seen[i].insert(b).second)
+                        continue;
+                    bindings[i].push_back(b);
+                    for (const CompiledCondition& effect : ca.effects)
                     {
-                        // name
-                        string predicate = iter->str();
-                        iter++;
-                        // args
-                        string args = iter->str();
-                        iter++;
-
-                        bool truth;
-
-                        if (predicate[0] == '!')
-                        {
-                            predicate = predicate.substr(1);
-                            truth = false;
-                        }
-                        else
-                        {
-                            truth = true;
-                        }
-
-                        Condition effect(predicate, parse_symbols(args), truth);
-                        effects.insert(effect);
+                        if (effect.truth && add_fact(this->atoms->intern_atom(effect.predicate, condition_args(effect, b))))
+                            changed = true;
                     }
-
-                    env->add_action(
-                        Action(action_name, parse_symbols(action_args), preconditions, effects));
-
-                    preconditions.clear();
-                    effects.clear();
-                    parser = ACTION_DEFINITION;
-                }
-                else
-                {
-                    cout << "Effects not specified correctly." << endl;
-                    throw;
                 }
             }
         }
-        input_file.close();
+        return bindings;
     }
 
-    else
-        cout << "Unable to open file";
+    // Initial atoms that kept ground() from instantiating an action, in increasing order. From an
+    // initial state without one of them, actions are applicable that ground() left out.
+    vector<int> get_static_blockers() const
+    {
+        return vector<int>(this->static_blockers.begin(), this->static_blockers.end());
+    }
+};
+
+// Search algorithm run by SymbolicPlanner
+enum SearchEngine
+{
+    ASTAR, // f = g + weight * h (weighted A* for weight > 1)
+    GBFS, // greedy best-first, f = h, stops at the first goal
+    RWASTAR, // anytime restarting weighted A*, see restarting_weighted_a_star
+    HDASTAR // multi-threaded hash distributed A*, see hash_distributed_a_star
+};
+
+// Why the last search stopped
+enum SearchStatus
+{
+    SEARCHING,
+    SOLVED,
+    UNSOLVABLE,
+    NODE_LIMIT,
+    TIME_LIMIT,
+    MEMORY_LIMIT,
+    OUT_OF_TASK, // a BatchPlanner query whose initial state the grounded task does not cover
+    ERROR // a BatchPlanner query with invalid search options, see PlanningResult::error
+};
+
+// Search configuration, set from the command line by planner_cli.cpp
+struct SearchOptions
+{
+    int heuristic = 1; // see SymbolicPlanner::heuristic
+    SearchEngine engine = ASTAR;
+    int weight = 1; // heuristic weight in f = g + weight * h (first weight of RWA*)
+    long node_limit = -1; // max expansions, -1 for no limit
+    double time_limit = -1; // seconds since the planner was created, -1 for no limit
+    long memory_limit = -1; // MB of peak resident memory, -1 for no limit
+    int threads = 0; // HDA* worker threads, 0 for one per hardware thread
+    int eval_threads = 1; // threads computing successor heuristics in A*, GBFS and RWA*
+    int goal_limit = 1; // distinct goal states to find before A*, GBFS or an RWA* iteration stops
+
+    // Largest weight accepted: f values index the buckets of the open list
+    static const int MAX_WEIGHT = 100;
+
+    // Throws invalid_argument for settings the search cannot run with
+    void validate() const
+    {
+        if (weight < 1 || weight > MAX_WEIGHT)
+            throw invalid_argument("weight must be between 1 and " + to_string(MAX_WEIGHT));
+        // HDA* proves its plan optimal before it stops, it does not collect more goal states
+        if (engine == HDASTAR && goal_limit != 1)
+            throw invalid_argument("hdastar only supports goals 1");
+    }
+
+    // The heuristic never overestimates the goal distance: zero and hmax. edl is not admissible,
+    // it can overestimate, and HDA* with it returns longer plans.
+    bool admissible() const
+    {
+        return heuristic == 0 || heuristic == 3;
+    }
 
+    // A* and HDA* with weight 1 and an admissible heuristic return optimal plans
+    bool optimal() const
+    {
+        return (engine == ASTAR || engine == HDASTAR) && weight == 1 && admissible();
+    }
+};
+
+// Grounded actions of a problem and the goal-independent structures built from them. The
+// planners of a BatchPlanner share one task and only keep their initial state and goal.
+struct GroundedTask
+{
+    vector<GroundedAction> actions;
+    int num_atoms = 0;
+    ZobristTable zobrist;
+    SuccessorGenerator successor_generator;
+    RelaxedHeuristic relaxed_heuristic; // goal set by each planner's copy
+    vector<int> static_blockers; // see Grounder::get_static_blockers
+
+    // Build the bitset masks, hashing, successor generator and heuristic once all atoms are known
+    void build(int num_atoms)
+    {
+        this->num_atoms = num_atoms;
+        for (GroundedAction& ga : this->actions)
+            ga.build_masks(num_atoms);
+        this->zobrist = ZobristTable(num_atoms);
+        for (GroundedAction& ga : this->actions)
+            ga.build_zobrist_delta(this->zobrist);
+        this->successor_generator = SuccessorGenerator(this->actions);
+        this->relaxed_heuristic = RelaxedHeuristic(this->actions, vector<int>(), num_atoms);
+    }
+};
+
+class SymbolicPlanner
+{
+    private:
+        shared_ptr<GroundedTask> task;
+        Env* env; // nullptr for a planner of an already grounded task
+        vector<int> initial_atoms;
+        vector<int> goal_atoms;
+        State goal_mask;
+        RelaxedHeuristic relaxed_heuristic; // the task's, with goal_atoms
+        unique_ptr<ThreadPool> eval_pool; // only with options.eval_threads > 1
+        vector<RelaxedHeuristic> eval_heuristics; // pool thread index, scratch buffers
+
+        void init_search_context();
+
+    public:
+        SymbolicPlanner(Env* env, const SearchOptions& options = SearchOptions())
+        {
+            this->task = make_shared<GroundedTask>();
+            this->env = env;
+            this->initial_atoms = env->get_initial_atoms();
+            this->goal_atoms = env->get_goal_atoms();
+            this->options = options;
+            this->start_time = wall_clock_seconds();
+        }
+
+        // Planner for one initial state and goal of a task that is already grounded
+        SymbolicPlanner(shared_ptr<GroundedTask> task, const vector<int>& initial_atoms, const vector<int>& goal_atoms,
+                        const SearchOptions& options = SearchOptions())
+        {
+            this->task = task;
+            this->env = nullptr;
+            this->initial_atoms = initial_atoms;
+            this->goal_atoms = goal_atoms;
+            this->options = options;
+            this->start_time = wall_clock_seconds();
+            init_search_context();
+        }
+        struct node
+        {
+            int g = std::numeric_limits<int>::max();
+            int h = 0;
+            bool closed = false;
+            bool evaluated = false; // h is the heuristic value, computed once per state
+        };
+
+        StateRegistry state_registry; // unique states, state id
+        RecordPool<node> node_info; // state id, node
+        RecordPool<ParentRecord> parents; // state id, how it was reached
+        vector<StateID> goal_ids; // reached goal states, in the order they were found
+        int first_goal_expansions = -1; // expansions when the first goal was found
+        StateID start_id = NO_STATE;
+        int num_expanded = 0;
+        long num_generated = 0; // successors generated by expansions
+        PlannerStats stats; // only collected with PLANNER_STATS
+
+        SearchOptions options;
+        SearchStatus status = SEARCHING;
+        double start_time;
+
+        int cost_bound = numeric_limits<int>::max(); // prune paths not cheaper than this
+        list<GroundedAction> best_plan; // cheapest plan found by RWA*
+        bool plan_proven_optimal = false; // RWA* exhausted the space below the cost of best_plan
+        vector<int> plan_actions; // action indices of the last plan returned by a search
+        // called with every improved plan found by RWA*
+        function<void(const list<GroundedAction>&, int weight)> on_plan_found;
+
+        PlanCache* plan_cache = nullptr; // seeds the heuristic if set, see PlanCache
+        uint64_t goal_key = 0; // PlanCache::goal_key of goal_atoms
+
+        // state ids by f value, then h value
+        BucketOpenList open_list;
+        const vector<GroundedAction>& get_grounded_actions() const
+        {
+            return this->task->actions;
+        }
+
+        shared_ptr<GroundedTask> get_task() const
+        {
+            return this->task;
+        }
+
+        list<GroundedAction> backtrack();
+        list<GroundedAction> backtrack(StateID goal_id);
+        void set_query(const vector<int> &initial_atoms, const vector<int> &goal_atoms, const SearchOptions &options);
+        void compute_all_grounded_actions();
+        void set_grounded_actions(vector<GroundedAction> actions, vector<int> static_blockers);
+        int heuristic(const State &state);
+        int heuristic(const State &state, RelaxedHeuristic &relaxed);
+        int simple_heur(const State &state);
+        int empty_delete_list_heur(const State &state);
+        int hmax_heur(const State &state, RelaxedHeuristic &relaxed);
+        int hadd_heur(const State &state, RelaxedHeuristic &relaxed);
+        int ff_heur(const State &state, RelaxedHeuristic &relaxed);
+        void init_start_node();
+        void restart_search();
+        int f_value(int g, int h);
+        void open_node(StateID id);
+        bool is_action_valid(const State &state, const GroundedAction &action);
+        State take_action(const State &state, const GroundedAction &a);
+        bool goal_reached(const State &state);
+        bool record_goal(StateID goal_id);
+        bool limits_exceeded();
+        void a_star_search();
+        void restarting_weighted_a_star();
+        int hda_owner(uint64_t hash, int num_workers);
+        void hda_insert(HDAWorker &worker, HDAShared &shared, const State &state, uint64_t hash, int g, int action, int parent_worker, StateID parent_id);
+        void hda_flush(vector<unique_ptr<HDAWorker>> &workers, int worker_id, HDAShared &shared, size_t min_size);
+        void hda_worker(vector<unique_ptr<HDAWorker>> &workers, int worker_id, HDAShared &shared);
+        list<GroundedAction> hash_distributed_a_star();
+        list<GroundedAction> search();
+        State take_action_relaxed(const State &state, const GroundedAction &a);
+
+        // list<GroundedAction> backtrack();
+};
+
+// Parse a problem file into a new environment. Throws ParseError (with line and column) on a
+// syntax error; an unreadable file gives an empty environment as before. With task_cache enabled
+// the environment of a cached task is read instead, and planner() takes its grounded actions.
+Env* create_env(char* filename)
+{
+    env_parse_time = 0;
+    PhaseTimer timer(env_parse_time);
+    Env* env = new Env();
+    MappedFile input_file;
+    if (!input_file.open(filename))
+    {
+        cout << "Unable to open file";
+        return env;
+    }
+    if (task_cache.lookup(input_file.begin(), input_file.end()))
+    {
+        delete env;
+        return task_cache.create_env();
+    }
+    ProblemParser parser(filename, input_file.begin(), input_file.end(), env);
+    parser.parse();
     return env;
 }
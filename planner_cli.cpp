@@ -0,0 +1,116 @@
+// Command line front end for the planner. Same output as planner.cpp's main, but the heuristic,
+// search engine and limits are chosen at run time:
+//
+//     planner_cli.out Blocks.txt --heuristic ff --weight 2 --time-limit 10
+#define PLANNER_NO_MAIN
+#include "planner.cpp"
+
+void print_usage(const char* program)
+{
+    cout << "Usage: " << program << " <problem file> [options]" << endl
+         << "  --heuristic <zero|goalcount|edl|hmax|hadd|ff|0-5>  heuristic (default goalcount)" << endl
+         << "  --engine <astar|gbfs|rwastar|hdastar>             search engine (default astar)" << endl
+         << "  --weight <w>                                      f = g + w * h, 1 to 100 (default 1, first RWA* weight)" << endl
+         << "  --threads <n>                                     HDA* threads (default one per hardware thread)" << endl
+         << "  --eval-threads <n>                                threads computing successor heuristics (default 1)" << endl
+         << "  --goals <n>                                       goal states to find before stopping (default 1, 1 for hdastar)" << endl
+         << "  --node-limit <n>                                  max number of expansions" << endl
+         << "  --time-limit <seconds>                            max planning time" << endl
+         << "  --memory-limit <MB>                               max peak resident memory" << endl
+         << "  --cache-dir <dir>                                 cache grounded tasks in dir to skip parsing and grounding" << endl
+         << "  --quiet                                           do not print the environment" << endl
+         << "  --debug                                           print all grounded actions" << endl;
+}
+
+// Parse the options after the problem file into search_options and the output flags
+void parse_options(int argc, char* argv[])
+{
+    for (int i = 2; i < argc; i++)
+    {
+        string option = argv[i];
+        if (option == "--quiet")
+        {
+            print_status = false;
+            continue;
+        }
+        if (option == "--debug")
+        {
+            debug = true;
+            continue;
+        }
+
+        if (i + 1 >= argc)
+            throw invalid_argument("missing value for " + option);
+        string value = argv[++i];
+        if (option == "--heuristic")
+            search_options.heuristic = parse_heuristic(value);
+        else if (option == "--engine")
+            search_options.engine = parse_engine(value);
+        else if (option == "--weight")
+            search_options.weight = stoi(value);
+        else if (option == "--threads")
+            search_options.threads = stoi(value);
+        else if (option == "--eval-threads")
+            search_options.eval_threads = stoi(value);
+        else if (option == "--goals")
+            search_options.goal_limit = stoi(value);
+        else if (option == "--node-limit")
+            search_options.node_limit = stol(value);
+        else if (option == "--time-limit")
+            search_options.time_limit = stod(value);
+        else if (option == "--memory-limit")
+            search_options.memory_limit = stol(value);
+        else if (option == "--cache-dir")
+            task_cache.set_dir(value);
+        else
+            throw invalid_argument("unknown option " + option);
+    }
+    search_options.validate();
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        parse_options(argc, argv);
+    }
+    catch (const exception& e)
+    {
+        cout << "Error: " << e.what() << endl;
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    char* filename = argv[1];
+    cout << "Environment: " << filename << endl << endl;
+    Env* env;
+    try
+    {
+        env = create_env(filename);
+    }
+    catch (const ParseError& e)
+    {
+        cout << "Error: " << e.what() << endl;
+        return 1;
+    }
+    if (print_status)
+    {
+        cout << *env;
+    }
+
+    list<GroundedAction> actions = planner(env);
+
+    cout << "\nPlan: " << endl;
+    for (const GroundedAction& gac : actions)
+    {
+        cout << gac << endl;
+    }
+
+    return actions.empty() && !env->get_goal_atoms().empty() ? 1 : 0;
+}
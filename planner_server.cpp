@@ -0,0 +1,553 @@
+// Planner server: grounds one problem at startup, then answers planning requests, one JSON object
+// per line, on stdin/stdout or on a Unix socket. Every request is an initial state and a goal over
+// the problem's symbols; missing fields default to the problem file's.
+//
+//     planner_server.out Blocks.txt --threads 4 [--socket /tmp/planner.sock]
+//     > {"id": 1, "goal": "On(B,A)", "heuristic": "ff"}
+//     < {"id": 1, "status": "SOLVED", "plan": ["MoveToTable(A,B)", "Move(B,Table,A)"], "plan_length": 2, ...}
+//
+// Request fields: id (echoed), initial and goal (condition lists as in the problem file, as one
+// string or an array of strings), heuristic, engine, weight (1 to 100), goals, node_limit, time_limit
+// (non-negative). Invalid requests get an ERROR response and are not searched. Requests
+// are planned concurrently, so responses can come out of order and carry the request's id.
+// {"command": "stats"} returns the plan cache counters (--plan-cache-mb).
+#define PLANNER_NO_MAIN
+#include "planner.cpp"
+
+#include <map>
+#include <deque>
+#include <sstream>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// A value of a flat JSON object: strings unescaped (arrays of strings joined with ", "), other
+// values as written
+struct JsonValue
+{
+    string text;
+    bool is_string = false;
+};
+
+// Minimal reader of the flat JSON objects of the protocol. Throws invalid_argument.
+class JsonReader
+{
+private:
+    const string& s;
+    size_t p = 0;
+
+    void skip_spaces()
+    {
+        while (this->p < this->s.size() && isspace((unsigned char)this->s[this->p]))
+            this->p++;
+    }
+
+    bool accept(char c)
+    {
+        skip_spaces();
+        if (this->p < this->s.size() && this->s[this->p] == c)
+        {
+            this->p++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c)
+    {
+        if (!accept(c))
+            throw invalid_argument(string("expected '") + c + "' at column " + to_string(this->p + 1));
+    }
+
+    // UTF-8 encoding of a \uXXXX escape (surrogate pairs are not combined)
+    void append_code_point(string& out, unsigned code)
+    {
+        if (code < 0x80)
+            out += (char)code;
+        else if (code < 0x800)
+        {
+            out += (char)(0xc0 | (code >> 6));
+            out += (char)(0x80 | (code & 0x3f));
+        }
+        else
+        {
+            out += (char)(0xe0 | (code >> 12));
+            out += (char)(0x80 | ((code >> 6) & 0x3f));
+            out += (char)(0x80 | (code & 0x3f));
+        }
+    }
+
+    string read_string()
+    {
+        expect('"');
+        string out;
+        while (true)
+        {
+            if (this->p >= this->s.size())
+                throw invalid_argument("unterminated string");
+            char c = this->s[this->p++];
+            if (c == '"')
+                return out;
+            if (c != '\\')
+            {
+                out += c;
+                continue;
+            }
+            if (this->p >= this->s.size())
+                throw invalid_argument("unterminated string");
+            char e = this->s[this->p++];
+            switch (e)
+            {
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                {
+                    if (this->p + 4 > this->s.size())
+                        throw invalid_argument("bad \\u escape");
+                    append_code_point(out, stoul(this->s.substr(this->p, 4), nullptr, 16));
+                    this->p += 4;
+                    break;
+                }
+                default:
+                    out += e; // \" \\ \/
+            }
+        }
+    }
+
+    JsonValue read_value()
+    {
+        skip_spaces();
+        JsonValue value;
+        if (this->p < this->s.size() && this->s[this->p] == '"')
+        {
+            value.text = read_string();
+            value.is_string = true;
+            return value;
+        }
+        if (accept('['))
+        {
+            value.is_string = true;
+            if (accept(']'))
+                return value;
+            do
+                value.text += (value.text.empty() ? "" : ", ") + read_string();
+            while (accept(','));
+            expect(']');
+            return value;
+        }
+        size_t start = this->p;
+        while (this->p < this->s.size() && (isalnum((unsigned char)this->s[this->p]) || strchr("+-.", this->s[this->p])))
+            this->p++;
+        value.text = this->s.substr(start, this->p - start);
+        if (value.text.empty())
+            throw invalid_argument("expected a value at column " + to_string(this->p + 1));
+        return value;
+    }
+
+public:
+    JsonReader(const string& s)
+        : s(s)
+    {
+    }
+
+    map<string, JsonValue> read_object()
+    {
+        map<string, JsonValue> object;
+        expect('{');
+        if (!accept('}'))
+        {
+            do
+            {
+                skip_spaces();
+                string key = read_string();
+                expect(':');
+                object[key] = read_value();
+            } while (accept(','));
+            expect('}');
+        }
+        skip_spaces();
+        if (this->p != this->s.size())
+            throw invalid_argument("unexpected text after the object");
+        return object;
+    }
+};
+
+string json_string(const string& s)
+{
+    string out = "\"";
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            out += string("\\") + c;
+        else if (c == '\n')
+            out += "\\n";
+        else if ((unsigned char)c < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        }
+        else
+            out += c;
+    }
+    return out + "\"";
+}
+
+// One client: requests are read from in_fd and responses written to out_fd, a line each.
+// Responses of concurrent requests are written whole under write_mutex.
+struct Connection
+{
+    int in_fd;
+    int out_fd;
+    bool owns_fds; // close the fds once the last request of the connection was answered
+    mutex write_mutex;
+
+    Connection(int in_fd, int out_fd, bool owns_fds)
+    {
+        this->in_fd = in_fd;
+        this->out_fd = out_fd;
+        this->owns_fds = owns_fds;
+    }
+
+    ~Connection()
+    {
+        if (this->owns_fds)
+            close(this->in_fd);
+    }
+
+    void write_line(const string& line)
+    {
+        lock_guard<mutex> lock(this->write_mutex);
+        string data = line + "\n";
+        size_t written = 0;
+        while (written < data.size())
+        {
+            ssize_t n = send(this->out_fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+            if (n < 0 && errno == ENOTSOCK)
+                n = write(this->out_fd, data.data() + written, data.size() - written);
+            if (n <= 0)
+                return; // client gone
+            written += n;
+        }
+    }
+};
+
+struct Request
+{
+    string line;
+    shared_ptr<Connection> connection;
+    double received; // wall clock seconds
+};
+
+// Requests waiting for a worker thread
+class RequestQueue
+{
+private:
+    deque<Request> requests;
+    mutex queue_mutex;
+    condition_variable ready;
+    bool closed = false;
+
+public:
+    void push(Request request)
+    {
+        lock_guard<mutex> lock(this->queue_mutex);
+        this->requests.push_back(move(request));
+        this->ready.notify_one();
+    }
+
+    // false once the queue is closed and empty
+    bool pop(Request& request)
+    {
+        unique_lock<mutex> lock(this->queue_mutex);
+        this->ready.wait(lock, [&] { return this->closed || !this->requests.empty(); });
+        if (this->requests.empty())
+            return false;
+        request = move(this->requests.front());
+        this->requests.pop_front();
+        return true;
+    }
+
+    void close()
+    {
+        lock_guard<mutex> lock(this->queue_mutex);
+        this->closed = true;
+        this->ready.notify_all();
+    }
+};
+
+struct ServerOptions
+{
+    string socket_path; // empty for stdin/stdout
+    int threads = 1;
+    size_t plan_cache_bytes = 0;
+};
+
+class PlannerServer
+{
+private:
+    BatchPlanner* batch;
+    string default_initial; // condition lists of the problem file
+    string default_goal;
+    RequestQueue queue;
+
+    static string conditions_text(const Env& env, const vector<int>& atom_ids)
+    {
+        string text;
+        for (int atom_id : atom_ids)
+            text += (text.empty() ? "" : ", ") + env.get_atoms().atom_to_string(atom_id);
+        return text;
+    }
+
+    // Response line of one request line
+    string answer(const string& line, double received)
+    {
+        string id = "null";
+        try
+        {
+            map<string, JsonValue> request = JsonReader(line).read_object();
+            if (request.count("id"))
+                id = request["id"].is_string ? json_string(request["id"].text) : request["id"].text;
+            if (request.count("command"))
+            {
+                if (request["command"].text != "stats")
+                    throw invalid_argument("unknown command " + request["command"].text);
+                ostringstream out;
+                out << "{\"id\": " << id << ", \"plan_cache\": ";
+                if (this->batch->get_plan_cache() != nullptr)
+                    this->batch->get_plan_cache()->dump(out);
+                else
+                    out << "null";
+                out << "}";
+                return out.str();
+            }
+
+            string initial = request.count("initial") ? request["initial"].text : this->default_initial;
+            string goal = request.count("goal") ? request["goal"].text : this->default_goal;
+            PlanningQuery query = this->batch->query(initial, goal);
+            for (const auto& field : request)
+            {
+                const string& key = field.first;
+                const string& value = field.second.text;
+                if (key == "id" || key == "initial" || key == "goal")
+                    continue;
+                else if (key == "heuristic")
+                    query.options.heuristic = parse_heuristic(value);
+                else if (key == "engine")
+                    query.options.engine = parse_engine(value);
+                else if (key == "weight")
+                    query.options.weight = stoi(value);
+                else if (key == "goals")
+                    query.options.goal_limit = stoi(value);
+                else if (key == "node_limit")
+                    query.options.node_limit = stol(value);
+                else if (key == "time_limit")
+                    query.options.time_limit = stod(value);
+                else
+                    throw invalid_argument("unknown field " + key);
+                if ((key == "node_limit" && query.options.node_limit < 0) || (key == "time_limit" && !(query.options.time_limit >= 0)))
+                    throw invalid_argument(key + " must be a non-negative number");
+            }
+            PlanningResult result = this->batch->solve(query);
+            if (result.status == ERROR)
+                throw invalid_argument(result.error);
+            ostringstream out;
+            out << "{\"id\": " << id << ", \"status\": \"" << status_name(result.status) << "\", \"plan\": [";
+            bool first = true;
+            for (const GroundedAction& ga : result.plan)
+            {
+                out << (first ? "" : ", ") << json_string(ga.toString());
+                first = false;
+            }
+            out << "], \"plan_length\": " << (result.status == SOLVED || !result.plan.empty() ? (long)result.plan.size() : -1)
+                << ", \"expanded\": " << result.expanded << ", \"generated\": " << result.generated
+                << ", \"search_s\": " << result.search_time << ", \"total_s\": " << wall_clock_seconds() - received
+                << ", \"cached\": " << (result.cached ? "true" : "false") << "}";
+            return out.str();
+        }
+        catch (const exception& e)
+        {
+            return "{\"id\": " + id + ", \"status\": \"ERROR\", \"error\": " + json_string(e.what()) + "}";
+        }
+    }
+
+    void worker()
+    {
+        Request request;
+        while (this->queue.pop(request))
+        {
+            request.connection->write_line(answer(request.line, request.received));
+            request.connection.reset();
+        }
+    }
+
+    // Queue every non-empty line of the connection until its end
+    void read_requests(shared_ptr<Connection> connection)
+    {
+        string buffer;
+        char data[4096];
+        ssize_t n;
+        while ((n = read(connection->in_fd, data, sizeof(data))) > 0)
+        {
+            buffer.append(data, n);
+            size_t start = 0;
+            size_t end;
+            while ((end = buffer.find('\n', start)) != string::npos)
+            {
+                string line = buffer.substr(start, end - start);
+                if (line.find_first_not_of(" \t\r") != string::npos)
+                    this->queue.push(Request{ line, connection, wall_clock_seconds() });
+                start = end + 1;
+            }
+            buffer.erase(0, start);
+        }
+        if (buffer.find_first_not_of(" \t\r") != string::npos)
+            this->queue.push(Request{ buffer, connection, wall_clock_seconds() });
+    }
+
+    void serve_socket(const string& path)
+    {
+        int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (server_fd < 0 || path.size() >= sizeof(address.sun_path))
+            throw runtime_error("cannot create socket " + path);
+        strcpy(address.sun_path, path.c_str());
+        unlink(path.c_str());
+        if (bind(server_fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(server_fd, 64) != 0)
+            throw runtime_error("cannot listen on " + path);
+        cerr << "Listening on " << path << endl;
+
+        while (true)
+        {
+            int client_fd = accept(server_fd, nullptr, nullptr);
+            if (client_fd < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            shared_ptr<Connection> connection = make_shared<Connection>(client_fd, client_fd, true);
+            thread(&PlannerServer::read_requests, this, connection).detach();
+        }
+        close(server_fd);
+    }
+
+public:
+    PlannerServer(BatchPlanner* batch, Env* env)
+    {
+        this->batch = batch;
+        this->default_initial = conditions_text(*env, env->get_initial_atoms());
+        this->default_goal = conditions_text(*env, env->get_goal_atoms());
+    }
+
+    // Serve until stdin ends (the socket server runs until it is killed)
+    void run(const ServerOptions& options)
+    {
+        vector<thread> workers;
+        for (int i = 0; i < options.threads; i++)
+            workers.push_back(thread(&PlannerServer::worker, this));
+
+        if (options.socket_path.empty())
+            read_requests(make_shared<Connection>(0, 1, false));
+        else
+            serve_socket(options.socket_path);
+
+        this->queue.close();
+        for (thread& t : workers)
+            t.join();
+    }
+};
+
+void print_usage(const char* program)
+{
+    cerr << "Usage: " << program << " <problem file> [options]" << endl
+         << "  --socket <path>          listen on a Unix socket instead of stdin/stdout" << endl
+         << "  --threads <n>            requests planned concurrently (default 1)" << endl
+         << "  --heuristic <name>       default heuristic of the requests (default goalcount)" << endl
+         << "  --engine <name>          default search engine of the requests (default astar)" << endl
+         << "  --time-limit <seconds>   default time limit of the requests" << endl
+         << "  --cache-dir <dir>        cache the grounded task in dir" << endl
+         << "  --plan-cache-mb <MB>     cache plans, goal distances and heuristic values (default 0, off)" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    ServerOptions server_options;
+    SearchOptions options;
+    try
+    {
+        for (int i = 2; i < argc; i++)
+        {
+            string option = argv[i];
+            if (i + 1 >= argc)
+                throw invalid_argument("missing value for " + option);
+            string value = argv[++i];
+            if (option == "--socket")
+                server_options.socket_path = value;
+            else if (option == "--threads")
+                server_options.threads = max(1, stoi(value));
+            else if (option == "--heuristic")
+                options.heuristic = parse_heuristic(value);
+            else if (option == "--engine")
+                options.engine = parse_engine(value);
+            else if (option == "--time-limit")
+                options.time_limit = stod(value);
+            else if (option == "--cache-dir")
+                task_cache.set_dir(value);
+            else if (option == "--plan-cache-mb")
+                server_options.plan_cache_bytes = stod(value) * 1024 * 1024;
+            else
+                throw invalid_argument("unknown option " + option);
+        }
+    }
+    catch (const exception& e)
+    {
+        cerr << "Error: " << e.what() << endl;
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (!ifstream(argv[1]))
+    {
+        cerr << "Error: unable to open " << argv[1] << endl;
+        return 1;
+    }
+    Env* env;
+    try
+    {
+        env = create_env(argv[1]);
+    }
+    catch (const ParseError& e)
+    {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    BatchPlanner batch(env, options, 1, server_options.plan_cache_bytes);
+    cerr << "Ready: " << batch.get_task().actions.size() << " grounded actions" << endl;
+    PlannerServer server(&batch, env);
+    server.run(server_options);
+    delete env;
+    return 0;
+}
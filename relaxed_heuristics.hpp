@@ -0,0 +1,215 @@
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+
+using namespace std;
+
+// Heuristic value of states from which the goal is unreachable even without delete effects
+const int DEAD_END = numeric_limits<int>::max() / 2;
+
+// Delete-relaxation heuristics computed by a fact-level cost propagation (generalized Dijkstra)
+// over the grounded actions, in O(|actions| + |atoms|) per state up to the queue:
+//   h^max: cost of the most expensive goal atom, costs propagate as max over preconditions (admissible)
+//   h^add: sum of the goal atom costs, costs propagate as sum over preconditions
+//   h^FF:  size of a relaxed plan extracted backwards from the goal along h^add best supporters
+// Actions have unit cost and negative preconditions are ignored. The object keeps scratch
+// buffers between calls, so it is cheap to call but must not be shared between threads.
+// Copies share the action structure, only the goal and the scratch buffers are per object.
+class RelaxedHeuristic
+{
+public:
+    enum Kind
+    {
+        HMAX,
+        HADD,
+        HFF
+    };
+
+private:
+    struct Structure
+    {
+        int num_atoms = 0;
+        vector<vector<int>> preconditions; // action, precondition atoms
+        vector<vector<int>> add_effects; // action, add atoms
+        vector<vector<int>> precondition_of; // atom, actions having it as a precondition
+        vector<int> no_precondition_actions;
+    };
+
+    shared_ptr<const Structure> task;
+    vector<int> goal_atoms;
+
+    // scratch, reset on every call
+    vector<int> atom_cost;
+    vector<int> best_supporter; // atom, action that reached it cheapest (-1 if initially true)
+    vector<int> unsatisfied; // action, number of preconditions not reached yet
+    vector<int> action_cost; // action, sum or max of its precondition costs
+    vector<pair<int, int>> heap; // (cost, atom) min-heap
+    vector<char> marked_atom;
+    vector<char> marked_action;
+    vector<int> open_atoms;
+
+    void enqueue(int atom_id, int cost, int supporter)
+    {
+        if (cost >= this->atom_cost[atom_id])
+            return;
+        this->atom_cost[atom_id] = cost;
+        this->best_supporter[atom_id] = supporter;
+        this->heap.push_back(make_pair(cost, atom_id));
+        push_heap(this->heap.begin(), this->heap.end(), greater<pair<int, int>>());
+    }
+
+    void apply_action(int action)
+    {
+        int cost = this->action_cost[action] + 1;
+        for (int atom_id : this->task->add_effects[action])
+            enqueue(atom_id, cost, action);
+    }
+
+    // Propagate costs from state until all goal atoms are settled; false if some goal is unreachable
+    bool propagate(const State& state, bool use_max)
+    {
+        fill(this->atom_cost.begin(), this->atom_cost.end(), DEAD_END);
+        fill(this->best_supporter.begin(), this->best_supporter.end(), -1);
+        fill(this->action_cost.begin(), this->action_cost.end(), 0);
+        for (size_t a = 0; a < this->task->preconditions.size(); a++)
+            this->unsatisfied[a] = this->task->preconditions[a].size();
+        this->heap.clear();
+
+        for (int atom_id = 0; atom_id < this->task->num_atoms; atom_id++)
+        {
+            if (state.test(atom_id))
+                enqueue(atom_id, 0, -1);
+        }
+        for (int action : this->task->no_precondition_actions)
+            apply_action(action);
+
+        int goals_left = this->goal_atoms.size();
+        for (int atom_id : this->goal_atoms)
+        {
+            if (state.test(atom_id))
+                goals_left--;
+        }
+
+        while (!this->heap.empty() && goals_left > 0)
+        {
+            pop_heap(this->heap.begin(), this->heap.end(), greater<pair<int, int>>());
+            pair<int, int> top = this->heap.back();
+            this->heap.pop_back();
+            int cost = top.first;
+            int atom_id = top.second;
+            if (cost > this->atom_cost[atom_id])
+                continue;
+
+            if (cost > 0 && binary_search(this->goal_atoms.begin(), this->goal_atoms.end(), atom_id))
+                goals_left--;
+
+            for (int action : this->task->precondition_of[atom_id])
+            {
+                if (use_max)
+                    this->action_cost[action] = max(this->action_cost[action], cost);
+                else
+                    this->action_cost[action] += cost;
+                if (--this->unsatisfied[action] == 0)
+                    apply_action(action);
+            }
+        }
+        return goals_left == 0;
+    }
+
+    int relaxed_plan_size()
+    {
+        fill(this->marked_atom.begin(), this->marked_atom.end(), 0);
+        fill(this->marked_action.begin(), this->marked_action.end(), 0);
+        this->open_atoms.clear();
+        for (int atom_id : this->goal_atoms)
+        {
+            this->marked_atom[atom_id] = 1;
+            this->open_atoms.push_back(atom_id);
+        }
+
+        int plan_size = 0;
+        while (!this->open_atoms.empty())
+        {
+            int atom_id = this->open_atoms.back();
+            this->open_atoms.pop_back();
+            int action = this->best_supporter[atom_id];
+            if (action == -1 || this->marked_action[action])
+                continue;
+            this->marked_action[action] = 1;
+            plan_size++;
+            for (int pre : this->task->preconditions[action])
+            {
+                if (!this->marked_atom[pre])
+                {
+                    this->marked_atom[pre] = 1;
+                    this->open_atoms.push_back(pre);
+                }
+            }
+        }
+        return plan_size;
+    }
+
+public:
+    RelaxedHeuristic() {}
+
+    RelaxedHeuristic(const vector<GroundedAction>& actions, const vector<int>& goal_atoms, int num_atoms)
+    {
+        shared_ptr<Structure> task = make_shared<Structure>();
+        task->num_atoms = num_atoms;
+        task->precondition_of.resize(num_atoms);
+        for (size_t a = 0; a < actions.size(); a++)
+        {
+            vector<int> pre = actions[a].get_precondition_atoms();
+            sort(pre.begin(), pre.end());
+            pre.erase(unique(pre.begin(), pre.end()), pre.end());
+            for (int atom_id : pre)
+                task->precondition_of[atom_id].push_back(a);
+            if (pre.empty())
+                task->no_precondition_actions.push_back(a);
+            task->preconditions.push_back(pre);
+            task->add_effects.push_back(actions[a].get_add_atoms());
+        }
+        this->task = task;
+        set_goal(goal_atoms);
+
+        this->atom_cost.resize(num_atoms);
+        this->best_supporter.resize(num_atoms);
+        this->marked_atom.resize(num_atoms);
+        this->unsatisfied.resize(actions.size());
+        this->action_cost.resize(actions.size());
+        this->marked_action.resize(actions.size());
+    }
+
+    void set_goal(const vector<int>& goal_atoms)
+    {
+        this->goal_atoms = goal_atoms;
+        sort(this->goal_atoms.begin(), this->goal_atoms.end());
+        this->goal_atoms.erase(unique(this->goal_atoms.begin(), this->goal_atoms.end()), this->goal_atoms.end());
+    }
+
+    // Heuristic value of state, DEAD_END if the goal is unreachable in the relaxation
+    int compute(const State& state, Kind kind)
+    {
+        if (!propagate(state, kind == HMAX))
+            return DEAD_END;
+
+        int h = 0;
+        switch (kind)
+        {
+            case HMAX:
+                for (int atom_id : this->goal_atoms)
+                    h = max(h, this->atom_cost[atom_id]);
+                break;
+            case HADD:
+                for (int atom_id : this->goal_atoms)
+                    h += this->atom_cost[atom_id];
+                break;
+            case HFF:
+                h = relaxed_plan_size();
+                break;
+        }
+        return h;
+    }
+};
@@ -0,0 +1,22 @@
+#include <chrono>
+#include <sys/resource.h>
+
+using namespace std;
+
+// Wall-clock seconds since an arbitrary fixed point
+double wall_clock_seconds()
+{
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Peak resident memory of this process in KB
+long peak_memory_kb()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    return usage.ru_maxrss; // KB on Linux
+#endif
+}
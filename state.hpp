@@ -0,0 +1,165 @@
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <random>
+
+using namespace std;
+
+// Fixed-width bitset over interned atom ids: bit i is set iff atom i holds.
+// All states and action masks of one task share the same width.
+class State
+{
+private:
+    vector<uint64_t> words;
+
+public:
+    State() {}
+
+    State(int num_atoms)
+    {
+        this->words.assign((num_atoms + 63) / 64, 0);
+    }
+
+    State(int num_atoms, const vector<int>& atom_ids)
+    {
+        this->words.assign((num_atoms + 63) / 64, 0);
+        for (int atom_id : atom_ids)
+            set(atom_id);
+    }
+
+    void set(int atom_id)
+    {
+        this->words[atom_id >> 6] |= (uint64_t(1) << (atom_id & 63));
+    }
+
+    void reset(int atom_id)
+    {
+        this->words[atom_id >> 6] &= ~(uint64_t(1) << (atom_id & 63));
+    }
+
+    bool test(int atom_id) const
+    {
+        return (this->words[atom_id >> 6] >> (atom_id & 63)) & 1;
+    }
+
+    int num_words() const
+    {
+        return this->words.size();
+    }
+
+    const vector<uint64_t>& get_words() const
+    {
+        return this->words;
+    }
+
+    void set_words(const uint64_t* src)
+    {
+        copy(src, src + this->words.size(), this->words.begin());
+    }
+
+    // (state & mask) == mask
+    bool contains(const State& mask) const
+    {
+        for (size_t i = 0; i < this->words.size(); i++)
+        {
+            if ((this->words[i] & mask.words[i]) != mask.words[i])
+                return false;
+        }
+        return true;
+    }
+
+    // (state & mask) != 0
+    bool intersects(const State& mask) const
+    {
+        for (size_t i = 0; i < this->words.size(); i++)
+        {
+            if (this->words[i] & mask.words[i])
+                return true;
+        }
+        return false;
+    }
+
+    // Number of atoms of mask that are not set in this state
+    int count_missing(const State& mask) const
+    {
+        int missing = 0;
+        for (size_t i = 0; i < this->words.size(); i++)
+            missing += __builtin_popcountll(mask.words[i] & ~this->words[i]);
+        return missing;
+    }
+
+    // state = (state & ~del) | add
+    void apply(const State& add, const State& del)
+    {
+        for (size_t i = 0; i < this->words.size(); i++)
+            this->words[i] = (this->words[i] & ~del.words[i]) | add.words[i];
+    }
+
+    // state = state | add
+    void apply_relaxed(const State& add)
+    {
+        for (size_t i = 0; i < this->words.size(); i++)
+            this->words[i] |= add.words[i];
+    }
+
+    // Atom ids of all set bits, in increasing order
+    vector<int> atoms() const
+    {
+        vector<int> atom_ids;
+        for (size_t i = 0; i < this->words.size(); i++)
+        {
+            uint64_t w = this->words[i];
+            while (w)
+            {
+                atom_ids.push_back(i * 64 + __builtin_ctzll(w));
+                w &= w - 1;
+            }
+        }
+        return atom_ids;
+    }
+
+    bool operator==(const State& rhs) const
+    {
+        return this->words == rhs.words;
+    }
+};
+
+// Random 64-bit key per atom. The Zobrist hash of a state is the XOR of the keys of its set atoms.
+class ZobristTable
+{
+private:
+    vector<uint64_t> keys;
+
+public:
+    ZobristTable() {}
+
+    ZobristTable(int num_atoms, uint64_t seed = 2023)
+    {
+        mt19937_64 rng(seed);
+        this->keys.resize(num_atoms);
+        for (int i = 0; i < num_atoms; i++)
+            this->keys[i] = rng();
+    }
+
+    uint64_t key(int atom_id) const
+    {
+        return this->keys[atom_id];
+    }
+
+    uint64_t hash_state(const State& state) const
+    {
+        uint64_t h = 0;
+        const vector<uint64_t>& words = state.get_words();
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            uint64_t w = words[i];
+            while (w)
+            {
+                h ^= this->keys[i * 64 + __builtin_ctzll(w)];
+                w &= w - 1;
+            }
+        }
+        return h;
+    }
+};
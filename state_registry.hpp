@@ -0,0 +1,151 @@
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+using namespace std;
+
+typedef uint32_t StateID;
+const StateID NO_STATE = numeric_limits<StateID>::max();
+
+// How a state was reached: its parent state and the action applied to it (8 bytes)
+struct ParentRecord
+{
+    StateID parent_id = NO_STATE;
+    int action = -1; // index into the grounded actions, -1 for the initial state
+};
+
+// Stores every unique state once and hands out dense 32-bit state ids. Each state is a record of
+// its Zobrist hash followed by its words in a RecordPool, so the storage of a search is a few
+// large chunks that clear() releases in O(1) for the next search.
+// States are deduplicated with an open-addressing table keyed by their Zobrist hash. Its slots
+// are stamped with the generation (search) that filled them, so clear() empties the table in O(1)
+// by starting a new generation.
+class StateRegistry
+{
+private:
+    struct Slot
+    {
+        StateID id = NO_STATE;
+        uint32_t generation = 0; // the slot is empty unless this is the registry's generation
+    };
+
+    const ZobristTable* zobrist;
+    int num_words;
+    RecordPool<uint64_t> records; // state id, hash then words
+    vector<Slot> table; // open addressing
+    size_t table_mask;
+    uint32_t generation = 1;
+
+    const uint64_t* words_of(StateID id) const
+    {
+        return this->records.record(id) + 1;
+    }
+
+    bool is_used(const Slot& slot) const
+    {
+        return slot.generation == this->generation;
+    }
+
+    void grow_table()
+    {
+        vector<Slot> new_table(this->table.size() * 2);
+        size_t new_mask = new_table.size() - 1;
+        for (const Slot& slot : this->table)
+        {
+            if (!is_used(slot))
+                continue;
+            size_t pos = get_hash(slot.id) & new_mask;
+            while (is_used(new_table[pos]))
+                pos = (pos + 1) & new_mask;
+            new_table[pos] = slot;
+        }
+        this->table.swap(new_table);
+        this->table_mask = new_mask;
+    }
+
+public:
+    StateRegistry()
+    {
+        this->zobrist = nullptr;
+        this->num_words = 0;
+        this->table_mask = 0;
+    }
+
+    StateRegistry(const ZobristTable& zobrist, int num_atoms)
+        : records((num_atoms + 63) / 64 + 1)
+    {
+        this->zobrist = &zobrist;
+        this->num_words = (num_atoms + 63) / 64;
+        this->table.assign(1024, Slot());
+        this->table_mask = this->table.size() - 1;
+    }
+
+    // Returns the id of the state and whether it was newly registered
+    pair<StateID, bool> insert_state(const State& state)
+    {
+        return insert_state(state, this->zobrist->hash_state(state));
+    }
+
+    // Same as above with a precomputed (e.g. incrementally updated) Zobrist hash.
+    // States with equal hashes are still compared word by word, so collisions cannot merge states.
+    pair<StateID, bool> insert_state(const State& state, uint64_t h)
+    {
+        const uint64_t* words = state.get_words().data();
+
+        size_t pos = h & this->table_mask;
+        while (is_used(this->table[pos]))
+        {
+            StateID id = this->table[pos].id;
+            if (get_hash(id) == h &&
+                memcmp(words_of(id), words, this->num_words * sizeof(uint64_t)) == 0)
+                return make_pair(id, false);
+            pos = (pos + 1) & this->table_mask;
+        }
+
+        StateID id = this->records.add();
+        uint64_t* r = this->records.record(id);
+        r[0] = h;
+        memcpy(r + 1, words, this->num_words * sizeof(uint64_t));
+        this->table[pos].id = id;
+        this->table[pos].generation = this->generation;
+        if (2 * this->records.size() > this->table.size())
+            grow_table();
+        return make_pair(id, true);
+    }
+
+    // Copy the words of a registered state into state
+    void get_state(StateID id, State& state) const
+    {
+        state.set_words(words_of(id));
+    }
+
+    State get_state(StateID id) const
+    {
+        State state(this->num_words * 64);
+        get_state(id, state);
+        return state;
+    }
+
+    uint64_t get_hash(StateID id) const
+    {
+        return this->records.record(id)[0];
+    }
+
+    size_t size() const
+    {
+        return this->records.size();
+    }
+
+    // Forget all states in O(1), keeping the allocated storage for the next search
+    void clear()
+    {
+        this->records.clear();
+        if (++this->generation == 0)
+        {
+            // the stamps wrapped around, old slots could look used again
+            fill(this->table.begin(), this->table.end(), Slot());
+            this->generation = 1;
+        }
+    }
+};
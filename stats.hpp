@@ -0,0 +1,98 @@
+#include <atomic>
+#include <ostream>
+
+using namespace std;
+
+// Search statistics are only collected when compiled with -DPLANNER_STATS. Otherwise every
+// count, peak and PhaseTimer below is a no-op on a constant false and compiles to nothing.
+#ifdef PLANNER_STATS
+const bool STATS_ENABLED = true;
+#else
+const bool STATS_ENABLED = false;
+#endif
+
+// Wall seconds spent in the last create_env
+double env_parse_time = 0;
+
+// Adds the wall time between its construction and destruction to total
+class PhaseTimer
+{
+private:
+    double* total;
+    double start = 0;
+
+public:
+    PhaseTimer(double& total)
+    {
+        this->total = &total;
+        if (STATS_ENABLED)
+            this->start = wall_clock_seconds();
+    }
+
+    ~PhaseTimer()
+    {
+        if (STATS_ENABLED)
+            *this->total += wall_clock_seconds() - this->start;
+    }
+};
+
+// Hot-path counters of a SymbolicPlanner. Counters are atomic because HDA* workers and the
+// heuristic thread pool update them concurrently; the phase times are set by one thread.
+struct PlannerStats
+{
+    atomic<long> duplicates{ 0 }; // successors that were already registered
+    atomic<long> reopened{ 0 }; // closed nodes reached again by a cheaper path
+    atomic<long> heuristic_calls{ 0 };
+    atomic<long> heuristic_ns{ 0 };
+    atomic<long> open_list_peak{ 0 }; // largest open list (of one worker in HDA*)
+
+    double parse_time = 0;
+    double grounding_time = 0;
+    double search_time = 0; // includes backtrack_time
+    double backtrack_time = 0;
+
+    void count(atomic<long>& counter, long n = 1)
+    {
+        if (STATS_ENABLED)
+            counter.fetch_add(n, memory_order_relaxed);
+    }
+
+    void peak(atomic<long>& counter, long value)
+    {
+        if (!STATS_ENABLED)
+            return;
+        long current = counter.load(memory_order_relaxed);
+        while (value > current && !counter.compare_exchange_weak(current, value, memory_order_relaxed))
+            ;
+    }
+
+    // Reset everything for the next search
+    void clear()
+    {
+        this->duplicates = 0;
+        this->reopened = 0;
+        this->heuristic_calls = 0;
+        this->heuristic_ns = 0;
+        this->open_list_peak = 0;
+        this->parse_time = 0;
+        this->grounding_time = 0;
+        this->search_time = 0;
+        this->backtrack_time = 0;
+    }
+
+    // One JSON object
+    void dump(ostream& out, long expanded, long generated) const
+    {
+        out << "{\"parse_s\": " << this->parse_time
+            << ", \"grounding_s\": " << this->grounding_time
+            << ", \"search_s\": " << this->search_time
+            << ", \"backtrack_s\": " << this->backtrack_time
+            << ", \"expanded\": " << expanded
+            << ", \"generated\": " << generated
+            << ", \"duplicates\": " << this->duplicates.load()
+            << ", \"reopened\": " << this->reopened.load()
+            << ", \"heuristic_calls\": " << this->heuristic_calls.load()
+            << ", \"heuristic_s\": " << this->heuristic_ns.load() / 1e9
+            << ", \"open_list_peak\": " << this->open_list_peak.load() << "}";
+    }
+};
@@ -0,0 +1,139 @@
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+// Decision tree over precondition atoms that returns the applicable actions of a state
+// without testing every grounded action (as in Fast Downward's successor generator).
+// Each inner node tests one atom: actions requiring it to be true sit below the true child,
+// actions requiring it to be false below the false child, and actions that do not mention
+// it below the don't-care child. Actions whose preconditions are all tested are stored at the node.
+class SuccessorGenerator
+{
+private:
+    struct GeneratorNode
+    {
+        int atom = -1; // tested atom, -1 for a leaf
+        int true_child = -1;
+        int false_child = -1;
+        int dont_care_child = -1;
+        int immediate_begin = 0; // range of immediate_actions applicable at this node
+        int immediate_end = 0;
+    };
+
+    vector<GeneratorNode> nodes; // node 0 is the root
+    vector<int> immediate_actions;
+    vector<vector<pair<int, bool>>> conditions; // action id, (atom, value) sorted by atom; only while building
+
+    // entries: (action id, number of its conditions already tested on the path to this node).
+    // Like generate, follows the don't-care chain iteratively and only recurses into true/false children.
+    int build_node(vector<pair<int, int>>& entries)
+    {
+        int first_node = -1;
+        int previous_node = -1;
+        while (!entries.empty())
+        {
+            int node_id = this->nodes.size();
+            this->nodes.push_back(GeneratorNode());
+            if (previous_node == -1)
+                first_node = node_id;
+            else
+                this->nodes[previous_node].dont_care_child = node_id;
+            previous_node = node_id;
+
+            int atom = -1;
+            this->nodes[node_id].immediate_begin = this->immediate_actions.size();
+            for (const pair<int, int>& entry : entries)
+            {
+                const vector<pair<int, bool>>& conds = this->conditions[entry.first];
+                if (entry.second == (int)conds.size())
+                    this->immediate_actions.push_back(entry.first);
+                else if (atom == -1 || conds[entry.second].first < atom)
+                    atom = conds[entry.second].first;
+            }
+            this->nodes[node_id].immediate_end = this->immediate_actions.size();
+            if (atom == -1)
+                break;
+
+            vector<pair<int, int>> true_entries;
+            vector<pair<int, int>> false_entries;
+            vector<pair<int, int>> dont_care_entries;
+            for (const pair<int, int>& entry : entries)
+            {
+                const vector<pair<int, bool>>& conds = this->conditions[entry.first];
+                if (entry.second == (int)conds.size())
+                    continue;
+                if (conds[entry.second].first != atom)
+                    dont_care_entries.push_back(entry);
+                else if (conds[entry.second].second)
+                    true_entries.push_back(make_pair(entry.first, entry.second + 1));
+                else
+                    false_entries.push_back(make_pair(entry.first, entry.second + 1));
+            }
+
+            this->nodes[node_id].atom = atom;
+            int child = build_node(true_entries);
+            this->nodes[node_id].true_child = child;
+            child = build_node(false_entries);
+            this->nodes[node_id].false_child = child;
+            entries.swap(dont_care_entries);
+        }
+        return first_node;
+    }
+
+    // Walk the don't-care chain iteratively and recurse only into true/false children,
+    // so the recursion depth is bounded by the number of preconditions of an action
+    void generate(int node_id, const State& state, vector<int>& applicable) const
+    {
+        while (node_id != -1)
+        {
+            const GeneratorNode& node = this->nodes[node_id];
+            for (int i = node.immediate_begin; i < node.immediate_end; i++)
+                applicable.push_back(this->immediate_actions[i]);
+            if (node.atom == -1)
+                return;
+
+            int child = state.test(node.atom) ? node.true_child : node.false_child;
+            if (child != -1)
+                generate(child, state, applicable);
+            node_id = node.dont_care_child;
+        }
+    }
+
+public:
+    SuccessorGenerator() {}
+
+    SuccessorGenerator(const vector<GroundedAction>& actions)
+    {
+        vector<pair<int, int>> entries;
+        for (size_t i = 0; i < actions.size(); i++)
+        {
+            vector<pair<int, bool>> conds;
+            for (int atom_id : actions[i].get_precondition_atoms())
+                conds.push_back(make_pair(atom_id, true));
+            for (int atom_id : actions[i].get_negative_precondition_atoms())
+                conds.push_back(make_pair(atom_id, false));
+            sort(conds.begin(), conds.end());
+            conds.erase(unique(conds.begin(), conds.end()), conds.end());
+            this->conditions.push_back(conds);
+            entries.push_back(make_pair(i, 0));
+        }
+        build_node(entries);
+        this->conditions.clear();
+        this->conditions.shrink_to_fit();
+    }
+
+    // Append the indices of all actions applicable in state to applicable, in increasing order
+    void generate_applicable_actions(const State& state, vector<int>& applicable) const
+    {
+        size_t first = applicable.size();
+        if (!this->nodes.empty())
+            generate(0, state, applicable);
+        sort(applicable.begin() + first, applicable.end());
+    }
+
+    size_t size() const
+    {
+        return this->nodes.size();
+    }
+};
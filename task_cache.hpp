@@ -0,0 +1,412 @@
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <unistd.h>
+
+using namespace std;
+
+// FNV-1a hash of a byte range, the key of a problem file in the task cache
+uint64_t fnv1a_hash(const char* begin, const char* end)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (const char* c = begin; c != end; c++)
+    {
+        h ^= (unsigned char)*c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Sections of a task cache file, in file order. Strings are the symbols, then the predicates,
+// then the action names, and string i spans [STRING_OFFSETS[i], STRING_OFFSETS[i + 1]) of
+// STRING_CHARS. Atoms and actions are stored the same way: ATOM_KEYS holds the predicate and
+// argument symbol ids of each atom, ACTION_DATA holds
+//
+//     name, #args, #pre, #negative pre, #add, #delete, args..., pre..., negative pre..., add..., delete...
+//
+// for each action. STATIC_BLOCKERS lists the atom ids of GroundedTask::static_blockers.
+// INITIAL_STATE and GOAL_STATE are bitsets over the atoms in uint64 words.
+enum TaskCacheSection
+{
+    STRING_OFFSETS,
+    STRING_CHARS,
+    ATOM_OFFSETS,
+    ATOM_KEYS,
+    ACTION_OFFSETS,
+    ACTION_DATA,
+    STATIC_BLOCKERS,
+    INITIAL_STATE,
+    GOAL_STATE,
+    NUM_TASK_CACHE_SECTIONS
+};
+
+const char TASK_CACHE_MAGIC[8] = { 'P', 'L', 'N', 'T', 'A', 'S', 'K', '2' };
+
+struct TaskCacheHeader
+{
+    char magic[8];
+    uint32_t byte_order; // 0x01020304 as written
+    uint32_t num_symbols;
+    uint32_t num_declared_symbols; // the first symbols, from the "Symbols:" line
+    uint32_t num_predicates;
+    uint32_t num_action_names;
+    uint32_t num_atoms;
+    uint32_t num_actions;
+    uint32_t num_static_blockers;
+    uint64_t key; // FNV-1a hash of the problem file
+    uint64_t section[NUM_TASK_CACHE_SECTIONS + 1]; // byte offsets, the last one is the file size
+};
+
+// Binary cache of grounded tasks, one file per problem file content (<dir>/<key>.task). A cached
+// task is memory-mapped and validated in place, so repeated runs on the same problem skip parsing
+// and grounding. Loading is not free of copies, by design: the planner and the batch planner keep
+// the Env and the GroundedActions after the mapping is closed (the next lookup replaces it), and
+// both own their data. create_env interns the names and atom keys into a new AtomTable straight
+// from the mapped tables and sets the initial and goal atoms by id; grounded_actions moves the
+// id lists of each action, read from the mapping once, into a new GroundedAction. Both allocate
+// about once per name, atom and action.
+// The action schemas are not stored, the environment of a cached task has none.
+class TaskCache
+{
+private:
+    string dir; // empty when the cache is disabled
+    uint64_t key = 0; // of the last lookup
+    MappedFile file;
+    const TaskCacheHeader* header = nullptr; // of the mapped task, nullptr on a miss
+
+    string path() const
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.task", (unsigned long long)this->key);
+        return this->dir + "/" + name;
+    }
+
+    template <typename T>
+    const T* section(TaskCacheSection s) const
+    {
+        return (const T*)(this->file.begin() + this->header->section[s]);
+    }
+
+    size_t section_size(TaskCacheSection s) const
+    {
+        return (this->header->section[s + 1] - this->header->section[s]) / 4;
+    }
+
+    // View into the mapping, valid until the next lookup
+    string_view get_string(int i) const
+    {
+        const uint32_t* offsets = section<uint32_t>(STRING_OFFSETS);
+        return string_view(section<char>(STRING_CHARS) + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+
+    // The mapped file is a well formed task for key: every offset and id is in range
+    bool validate() const
+    {
+        const TaskCacheHeader& h = *this->header;
+        if (this->file.size() < sizeof(TaskCacheHeader) || memcmp(h.magic, TASK_CACHE_MAGIC, 8) != 0
+            || h.byte_order != 0x01020304 || h.key != this->key || h.section[NUM_TASK_CACHE_SECTIONS] != this->file.size())
+            return false;
+        for (int s = 0; s < NUM_TASK_CACHE_SECTIONS; s++)
+        {
+            if (h.section[s] < sizeof(TaskCacheHeader) || h.section[s] > h.section[s + 1] || h.section[s] % 8 != 0)
+                return false;
+        }
+
+        size_t num_strings = (size_t)h.num_symbols + h.num_predicates + h.num_action_names;
+        size_t state_words = (h.num_atoms + 63) / 64;
+        if (section_size(STRING_OFFSETS) < num_strings + 1 || section_size(ATOM_OFFSETS) < (size_t)h.num_atoms + 1
+            || section_size(ACTION_OFFSETS) < (size_t)h.num_actions + 1 || h.num_declared_symbols > h.num_symbols
+            || section_size(STATIC_BLOCKERS) < h.num_static_blockers
+            || section_size(INITIAL_STATE) < state_words * 2 || section_size(GOAL_STATE) < state_words * 2)
+            return false;
+
+        // offsets are non-decreasing and inside their data section
+        auto check_offsets = [&](TaskCacheSection offsets_section, size_t n, size_t data_size)
+        {
+            const uint32_t* offsets = section<uint32_t>(offsets_section);
+            for (size_t i = 0; i < n; i++)
+            {
+                if (offsets[i] > offsets[i + 1])
+                    return false;
+            }
+            return offsets[0] == 0 && offsets[n] <= data_size;
+        };
+        size_t string_bytes = h.section[STRING_CHARS + 1] - h.section[STRING_CHARS];
+        if (!check_offsets(STRING_OFFSETS, num_strings, string_bytes)
+            || !check_offsets(ATOM_OFFSETS, h.num_atoms, section_size(ATOM_KEYS))
+            || !check_offsets(ACTION_OFFSETS, h.num_actions, section_size(ACTION_DATA)))
+            return false;
+
+        const uint32_t* atom_offsets = section<uint32_t>(ATOM_OFFSETS);
+        const uint32_t* atom_keys = section<uint32_t>(ATOM_KEYS);
+        for (uint32_t a = 0; a < h.num_atoms; a++)
+        {
+            if (atom_offsets[a] == atom_offsets[a + 1] || atom_keys[atom_offsets[a]] >= h.num_predicates)
+                return false;
+            for (uint32_t i = atom_offsets[a] + 1; i < atom_offsets[a + 1]; i++)
+            {
+                if (atom_keys[i] >= h.num_symbols)
+                    return false;
+            }
+        }
+
+        const uint32_t* action_offsets = section<uint32_t>(ACTION_OFFSETS);
+        const uint32_t* data = section<uint32_t>(ACTION_DATA);
+        for (uint32_t a = 0; a < h.num_actions; a++)
+        {
+            const uint32_t* r = data + action_offsets[a];
+            size_t length = action_offsets[a + 1] - action_offsets[a];
+            if (length < 6 || r[0] >= h.num_action_names || length != 6 + (size_t)r[1] + r[2] + r[3] + r[4] + r[5])
+                return false;
+            for (size_t i = 6; i < 6 + r[1]; i++)
+            {
+                if (r[i] >= h.num_symbols)
+                    return false;
+            }
+            for (size_t i = 6 + r[1]; i < length; i++)
+            {
+                if (r[i] >= h.num_atoms)
+                    return false;
+            }
+        }
+
+        const uint32_t* blockers = section<uint32_t>(STATIC_BLOCKERS);
+        for (uint32_t i = 0; i < h.num_static_blockers; i++)
+        {
+            if (blockers[i] >= h.num_atoms)
+                return false;
+        }
+        return true;
+    }
+
+public:
+    // Cache grounded tasks in dir, an empty dir disables the cache
+    void set_dir(const string& dir)
+    {
+        this->dir = dir;
+    }
+
+    bool enabled() const
+    {
+        return !this->dir.empty();
+    }
+
+    // Look up the task of a problem file's content, true if it is cached
+    bool lookup(const char* begin, const char* end)
+    {
+        this->file.close();
+        this->header = nullptr;
+        if (!enabled())
+            return false;
+        this->key = fnv1a_hash(begin, end);
+        if (!this->file.open(path()) || this->file.size() < sizeof(TaskCacheHeader))
+            return false;
+        this->header = (const TaskCacheHeader*)this->file.begin();
+        if (!validate())
+        {
+            this->header = nullptr;
+            this->file.close();
+            return false;
+        }
+        return true;
+    }
+
+    // The last lookup found the task
+    bool hit() const
+    {
+        return this->header != nullptr;
+    }
+
+    // Environment of the cached task, with the atom ids of the run that stored it
+    Env* create_env() const
+    {
+        const TaskCacheHeader& h = *this->header;
+        Env* env = new Env();
+        for (uint32_t i = 0; i < h.num_declared_symbols; i++)
+            env->add_symbol(get_string(i));
+
+        AtomTable& atoms = env->get_atoms();
+        for (uint32_t i = h.num_declared_symbols; i < h.num_symbols; i++)
+            atoms.intern_symbol(get_string(i));
+        for (uint32_t i = 0; i < h.num_predicates; i++)
+            atoms.intern_predicate(get_string(h.num_symbols + i));
+        const uint32_t* atom_offsets = section<uint32_t>(ATOM_OFFSETS);
+        const uint32_t* atom_keys = section<uint32_t>(ATOM_KEYS);
+        vector<int> args;
+        for (uint32_t a = 0; a < h.num_atoms; a++)
+        {
+            args.assign(atom_keys + atom_offsets[a] + 1, atom_keys + atom_offsets[a + 1]);
+            atoms.intern_atom(atom_keys[atom_offsets[a]], args);
+        }
+
+        // initial and goal conditions in atom id order
+        const uint64_t* initial = section<uint64_t>(INITIAL_STATE);
+        const uint64_t* goal = section<uint64_t>(GOAL_STATE);
+        for (uint32_t a = 0; a < h.num_atoms; a++)
+        {
+            if ((initial[a / 64] >> (a % 64)) & 1)
+                env->set_initial_atom(a, true);
+            if ((goal[a / 64] >> (a % 64)) & 1)
+                env->set_goal_atom(a, true);
+        }
+        return env;
+    }
+
+    // Grounded actions of the cached task, in the order of the run that stored it
+    vector<GroundedAction> grounded_actions() const
+    {
+        const TaskCacheHeader& h = *this->header;
+        vector<GroundedAction> actions;
+        actions.reserve(h.num_actions);
+        const uint32_t* action_offsets = section<uint32_t>(ACTION_OFFSETS);
+        const uint32_t* data = section<uint32_t>(ACTION_DATA);
+        for (uint32_t a = 0; a < h.num_actions; a++)
+        {
+            const uint32_t* r = data + action_offsets[a];
+            const uint32_t* p = r + 6;
+            list<string> args;
+            for (uint32_t i = 0; i < r[1]; i++)
+                args.emplace_back(get_string(*p++));
+            vector<int> lists[4]; // pre, negative pre, add, delete
+            for (int l = 0; l < 4; l++)
+            {
+                lists[l].assign(p, p + r[2 + l]);
+                p += r[2 + l];
+            }
+            actions.emplace_back(string(get_string(h.num_symbols + h.num_predicates + r[0])), move(args),
+                move(lists[0]), move(lists[1]), move(lists[2]), move(lists[3]));
+        }
+        return actions;
+    }
+
+    // Atoms whose initial truth pruned actions from the cached grounding, see GroundedTask
+    vector<int> static_blockers() const
+    {
+        const uint32_t* blockers = section<uint32_t>(STATIC_BLOCKERS);
+        return vector<int>(blockers, blockers + this->header->num_static_blockers);
+    }
+
+    // Write the grounded task of the last lookup. The file is renamed into place once complete,
+    // so concurrent runs never map a partial file. False if it cannot be written.
+    bool store(const Env& env, const vector<GroundedAction>& actions, const vector<int>& static_blockers) const
+    {
+        if (!enabled())
+            return false;
+        const AtomTable& atoms = env.get_atoms();
+        vector<uint32_t> words[NUM_TASK_CACHE_SECTIONS];
+        string chars;
+
+        unordered_map<string, int> name_ids;
+        vector<string> names;
+        for (const GroundedAction& ga : actions)
+        {
+            if (name_ids.emplace(ga.get_name(), names.size()).second)
+                names.push_back(ga.get_name());
+        }
+        auto add_string = [&](const string& s)
+        {
+            words[STRING_OFFSETS].push_back(chars.size());
+            chars += s;
+        };
+        for (int i = 0; i < atoms.num_symbols(); i++)
+            add_string(atoms.symbol_name(i));
+        for (int i = 0; i < atoms.num_predicates(); i++)
+            add_string(atoms.predicate_name(i));
+        for (const string& name : names)
+            add_string(name);
+        words[STRING_OFFSETS].push_back(chars.size());
+
+        for (int a = 0; a < atoms.num_atoms(); a++)
+        {
+            words[ATOM_OFFSETS].push_back(words[ATOM_KEYS].size());
+            const vector<int>& key = atoms.atom_key(a);
+            words[ATOM_KEYS].insert(words[ATOM_KEYS].end(), key.begin(), key.end());
+        }
+        words[ATOM_OFFSETS].push_back(words[ATOM_KEYS].size());
+
+        vector<uint32_t>& data = words[ACTION_DATA];
+        for (const GroundedAction& ga : actions)
+        {
+            words[ACTION_OFFSETS].push_back(data.size());
+            const vector<int>* lists[4] = { &ga.get_precondition_atoms(), &ga.get_negative_precondition_atoms(),
+                &ga.get_add_atoms(), &ga.get_delete_atoms() };
+            data.push_back(name_ids[ga.get_name()]);
+            data.push_back(ga.get_arg_values().size());
+            for (const vector<int>* l : lists)
+                data.push_back(l->size());
+            for (const string& arg : ga.get_arg_values())
+                data.push_back(atoms.find_symbol(arg));
+            for (const vector<int>* l : lists)
+                data.insert(data.end(), l->begin(), l->end());
+        }
+        words[ACTION_OFFSETS].push_back(data.size());
+        words[STATIC_BLOCKERS].assign(static_blockers.begin(), static_blockers.end());
+
+        // bitsets as pairs of uint32 words, in uint64 order
+        size_t state_words = (atoms.num_atoms() + 63) / 64;
+        vector<uint64_t> initial(state_words, 0);
+        vector<uint64_t> goal(state_words, 0);
+        for (int a : env.get_initial_atoms())
+            initial[a / 64] |= 1ULL << (a % 64);
+        for (int a : env.get_goal_atoms())
+            goal[a / 64] |= 1ULL << (a % 64);
+        words[INITIAL_STATE].resize(state_words * 2);
+        words[GOAL_STATE].resize(state_words * 2);
+        memcpy(words[INITIAL_STATE].data(), initial.data(), state_words * 8);
+        memcpy(words[GOAL_STATE].data(), goal.data(), state_words * 8);
+
+        TaskCacheHeader h;
+        memcpy(h.magic, TASK_CACHE_MAGIC, 8);
+        h.byte_order = 0x01020304;
+        h.num_symbols = atoms.num_symbols();
+        h.num_declared_symbols = env.get_symbols().size();
+        h.num_predicates = atoms.num_predicates();
+        h.num_action_names = names.size();
+        h.num_atoms = atoms.num_atoms();
+        h.num_actions = actions.size();
+        h.num_static_blockers = static_blockers.size();
+        h.key = this->key;
+
+        // sections start at multiples of 8 bytes
+        auto aligned = [](uint64_t offset) { return (offset + 7) / 8 * 8; };
+        uint64_t offset = aligned(sizeof(TaskCacheHeader));
+        for (int s = 0; s < NUM_TASK_CACHE_SECTIONS; s++)
+        {
+            h.section[s] = offset;
+            offset = aligned(offset + (s == STRING_CHARS ? chars.size() : words[s].size() * 4));
+        }
+        h.section[NUM_TASK_CACHE_SECTIONS] = offset;
+
+        string temp_path = path() + "." + to_string(getpid()) + ".tmp";
+        ofstream out(temp_path, ios::binary);
+        if (!out)
+            return false;
+        const char padding[8] = {};
+        out.write((const char*)&h, sizeof(h));
+        uint64_t written = sizeof(h);
+        for (int s = 0; s < NUM_TASK_CACHE_SECTIONS; s++)
+        {
+            out.write(padding, h.section[s] - written);
+            if (s == STRING_CHARS)
+                out.write(chars.data(), chars.size());
+            else
+                out.write((const char*)words[s].data(), words[s].size() * 4);
+            written = h.section[s] + (s == STRING_CHARS ? chars.size() : words[s].size() * 4);
+        }
+        out.write(padding, h.section[NUM_TASK_CACHE_SECTIONS] - written);
+        out.close();
+        if (!out || rename(temp_path.c_str(), path().c_str()) != 0)
+        {
+            unlink(temp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+};
+
+// Task cache used by create_env and planner(), disabled unless a directory is set
+TaskCache task_cache;
@@ -0,0 +1,114 @@
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+
+using namespace std;
+
+// Fixed set of threads running parallel loops. The calling thread takes part in every loop,
+// so a pool of size n starts n - 1 threads. Indices are handed out dynamically, and the
+// thread index passed to the task (0 for the caller) lets it use per-thread scratch data.
+class ThreadPool
+{
+private:
+    vector<thread> threads;
+    mutex pool_mutex;
+    condition_variable work_ready;
+    condition_variable work_done;
+
+    // current loop, guarded by pool_mutex except next_index
+    const function<void(size_t, int)>* task = nullptr;
+    size_t num_tasks = 0;
+    atomic<size_t> next_index;
+    size_t generation = 0; // incremented for every loop
+    int busy_threads = 0;
+    bool stopping = false;
+
+    void run_tasks(const function<void(size_t, int)>& f, size_t n, int thread_index)
+    {
+        size_t i;
+        while ((i = this->next_index.fetch_add(1)) < n)
+            f(i, thread_index);
+    }
+
+    void worker(int thread_index)
+    {
+        size_t seen_generation = 0;
+        while (true)
+        {
+            const function<void(size_t, int)>* f;
+            size_t n;
+            {
+                unique_lock<mutex> lock(this->pool_mutex);
+                this->work_ready.wait(lock, [&] { return this->stopping || this->generation != seen_generation; });
+                if (this->stopping)
+                    return;
+                seen_generation = this->generation;
+                f = this->task;
+                n = this->num_tasks;
+            }
+
+            run_tasks(*f, n, thread_index);
+
+            lock_guard<mutex> lock(this->pool_mutex);
+            if (--this->busy_threads == 0)
+                this->work_done.notify_one();
+        }
+    }
+
+public:
+    ThreadPool(int num_threads)
+    {
+        this->next_index = 0;
+        for (int i = 1; i < num_threads; i++)
+            this->threads.push_back(thread(&ThreadPool::worker, this, i));
+    }
+
+    ~ThreadPool()
+    {
+        {
+            lock_guard<mutex> lock(this->pool_mutex);
+            this->stopping = true;
+        }
+        this->work_ready.notify_all();
+        for (thread& t : this->threads)
+            t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads including the caller
+    int size() const
+    {
+        return this->threads.size() + 1;
+    }
+
+    // Call f(i, thread index) for every i in [0, n) and return once all calls finished
+    void parallel_for(size_t n, const function<void(size_t, int)>& f)
+    {
+        if (n <= 1 || this->threads.empty())
+        {
+            for (size_t i = 0; i < n; i++)
+                f(i, 0);
+            return;
+        }
+
+        {
+            lock_guard<mutex> lock(this->pool_mutex);
+            this->task = &f;
+            this->num_tasks = n;
+            this->next_index = 0;
+            this->busy_threads = this->threads.size();
+            this->generation++;
+        }
+        this->work_ready.notify_all();
+
+        run_tasks(f, n, 0);
+
+        unique_lock<mutex> lock(this->pool_mutex);
+        this->work_done.wait(lock, [&] { return this->busy_threads == 0; });
+    }
+};